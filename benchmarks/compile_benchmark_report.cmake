@@ -0,0 +1,7 @@
+# report the size of the compile benchmark objects, called with -DOBJECTS=<object files>
+
+foreach(object ${OBJECTS})
+  file(SIZE ${object} size)
+  get_filename_component(name ${object} NAME)
+  message("${name}: ${size} bytes")
+endforeach(object)
@@ -0,0 +1,81 @@
+/**
+* @copyright (c) 2015-2021 Ing. Buero Rothfuss
+*                          Riedlinger Str. 8
+*                          70327 Stuttgart
+*                          Germany
+*                          http://www.rothfuss-web.de
+*
+* @author    <a href="mailto:armin@rothfuss-web.de">Armin Rothfuss</a>
+*
+* Project    persistent lib
+*
+* @brief     C++ struct persistence benchmark
+*
+* @license   MIT license. See accompanying file LICENSE.
+*/
+
+#include <chrono>
+#include <iostream>
+
+#include "persistent/persistent_ptree.h"
+
+#include "test_structs.h"
+
+// --------------------------------------------------------------------------
+MpStat make_stat (std::size_t hosts, std::size_t statistics) {
+  MpStat s;
+  s.sysstat.hosts.resize(hosts);
+  for (Host& h : s.sysstat.hosts) {
+    h.nodename = "node";
+    h.sysname = "Linux";
+    h.number_of_cpus = 12;
+    h.statistics.resize(statistics);
+    for (Statistics& st : h.statistics) {
+      st.timestamp = "06:54:18 PM";
+      st.cpu_load.resize(13);
+      for (std::size_t i = 0; i < st.cpu_load.size(); ++i) {
+        st.cpu_load[i] = { std::to_string(i), 7.55F, 0.01F, 2.44F, 0.02F, 0, 0.02F, 0, 0, 0, 89.96F };
+      }
+    }
+  }
+  return s;
+}
+
+// --------------------------------------------------------------------------
+template<typename F>
+double measure (std::size_t loops, F f) {
+  const auto start = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i < loops; ++i) {
+    f();
+  }
+  const std::chrono::duration<double, std::milli> d = std::chrono::steady_clock::now() - start;
+  return d.count() / loops;
+}
+
+// --------------------------------------------------------------------------
+int main (int, char**) {
+  std::cout << "hosts statistics nodes write[ms] read[ms]" << std::endl;
+  for (std::size_t hosts : { 1, 10, 100 }) {
+    for (std::size_t statistics : { 1, 10, 100 }) {
+      const MpStat s = make_stat(hosts, statistics);
+      const std::size_t loops = 1000 / (hosts * statistics) + 1;
+
+      io::ptree pt;
+      const double write_ms = measure(loops, [&] () {
+        pt.clear();
+        io::write(pt, s);
+      });
+
+      const double read_ms = measure(loops, [&] () {
+        MpStat r;
+        io::read(pt, r);
+      });
+
+      const std::size_t nodes = hosts * (8 + statistics * (3 + 13 * 12));
+      std::cout << hosts << ' ' << statistics << ' ' << nodes << ' ' << write_ms << ' ' << read_ms << std::endl;
+    }
+  }
+  return 0;
+}
+
+// --------------------------------------------------------------------------
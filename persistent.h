@@ -22,6 +22,10 @@
 //
 #include <string>
 #include <functional>
+#include <vector>
+#include <algorithm>
+#include <charconv>
+#include <stdexcept>
 
 // --------------------------------------------------------------------------
 //
@@ -43,6 +47,30 @@ namespace persistent {
   template <typename T>
   struct is_persistent<T, typename std::enable_if<std::is_base_of<persistent_struct, T>::value>::type> : std::true_type {};
 
+  // --------------------------------------------------------------------------
+  //
+  // List of types
+  //
+  template<typename ... Types>
+  struct type_list {
+    typedef type_list types;
+  };
+
+  // --------------------------------------------------------------------------
+  //
+  // Registry of the persistent types derived from a polymorphic base.
+  // The tag of a type is its position in the list, specialize it for a base:
+  //   template<> struct derived_types<event> : type_list<click, key_press> {};
+  //
+  template<typename Base>
+  struct derived_types {};
+
+  template<typename Base, typename S = void>
+  struct is_registered_base : std::false_type {};
+
+  template<typename Base>
+  struct is_registered_base<Base, std::void_t<typename derived_types<Base>::types>> : std::true_type {};
+
   // --------------------------------------------------------------------------
   template<typename T>
   inline auto attributes (T& t) {
@@ -56,8 +84,8 @@ namespace persistent {
 
   // --------------------------------------------------------------------------
   template<typename... Ts>
-  inline auto make_attributes (Ts... a) {
-    return std::make_tuple(a...);
+  inline auto make_attributes (Ts&&... a) {
+    return std::make_tuple(std::forward<Ts>(a)...);
   }
 
   namespace detail {
@@ -88,43 +116,84 @@ namespace persistent {
     // --------------------------------------------------------------------------
     //
     // Wrapper for a named attribute of a persistent struct.
+    // A reference type T holds the result of the getter without copy.
     //
     template<typename T>
     struct getter : public property {
       typedef T type;
 
-      inline getter (T value, const std::string& name)
+      inline getter (T&& value, const std::string& name)
         : property(name)
-        , value(value)
+        , value(std::forward<T>(value))
       {}
 
       T value;    /// The attribute to read
     };
 
     // --------------------------------------------------------------------------
+    //
+    // Argument type of a setter method.
+    //
+    template<typename M>
+    struct method_argument;
+
+    template<class C, typename R, typename T>
+    struct method_argument<R (C::*)(T)> {
+      typedef T type;
+    };
+
+    template<class C, typename R, typename T>
+    struct method_argument<R (C::*)(T) noexcept> {
+      typedef T type;
+    };
+
+    // --------------------------------------------------------------------------
+    //
+    // Call of a setter method of an object.
+    //
     template<class C, typename T>
-    inline std::function<void(T)> bind (C* c, void(C::*method)(T)) {
-      return [=](T t) {
-        return (c->*method)(t);
-      };
-    }
+    struct method_call {
+      inline void operator() (std::remove_const_t<std::remove_reference_t<T>>&& value) const {
+        (c->*method)(std::move(value));
+      }
+
+      C* c;
+      void (C::*method)(T);
+    };
+
+    // --------------------------------------------------------------------------
+    //
+    // Call of the setter method Method of an object, known at compile time.
+    //
+    template<auto Method, class C>
+    struct bound_method {
+      template<typename V>
+      inline void operator() (V&& value) const {
+        (c->*Method)(std::forward<V>(value));
+      }
+
+      C* c;
+    };
 
     // --------------------------------------------------------------------------
     //
     // Wrapper for a named attribute of a persistent struct.
+    // F is called with the read value.
     //
-    template<typename T>
+    template<typename T, typename F = std::function<void(T)>>
     struct setter : public property {
-      inline setter (std::function<void(T)> fn, const std::string& name)
+      typedef std::remove_const_t<std::remove_reference_t<T>> type;
+
+      inline setter (F fn, const std::string& name)
         : property(name)
-        , fn(fn)
+        , fn(std::move(fn))
       {}
 
-      inline void call (T&& value) {
+      inline void call (type&& value) {
         fn(std::move(value));
       }
 
-      std::function<void(T)> fn; /// The method to write the attribute to
+      F fn; /// The method to write the attribute to
     };
 
   } // namespace detail
@@ -137,12 +206,26 @@ namespace persistent {
 
   template<typename T>
   inline detail::getter<T> getter (T&& value, const std::string& n) {
-    return detail::getter<T>(value, n);
+    return detail::getter<T>(std::forward<T>(value), n);
+  }
+
+  /// getter calling the method Method of c, a result returned by reference is not copied.
+  template<auto Method, class C>
+  inline auto getter (const C& c, const std::string& n) {
+    typedef decltype((c.*Method)()) result;
+    return detail::getter<result>((c.*Method)(), n);
   }
 
   template<class C, typename T>
-  inline detail::setter<T> setter (C& c, void(C::*method)(T), const std::string& n) {
-    return detail::setter<T>(detail::bind(&c, method), n);
+  inline detail::setter<T, detail::method_call<C, T>> setter (C& c, void(C::*method)(T), const std::string& n) {
+    return detail::setter<T, detail::method_call<C, T>>({ &c, method }, n);
+  }
+
+  /// setter calling the method Method of c, the call is resolved at compile time.
+  template<auto Method, class C>
+  inline auto setter (C& c, const std::string& n) {
+    typedef typename detail::method_argument<decltype(Method)>::type T;
+    return detail::setter<T, detail::bound_method<Method, C>>({ &c }, n);
   }
 
   template<typename T>
@@ -161,8 +244,8 @@ namespace persistent {
     return g.name;
   }
 
-  template<typename T>
-  inline const std::string& get_property_name (const detail::setter<T>& s) {
+  template<typename T, typename F>
+  inline const std::string& get_property_name (const detail::setter<T, F>& s) {
     return s.name;
   }
 
@@ -173,7 +256,7 @@ namespace persistent {
   }
 
   template<typename T>
-  inline const T get_property_value (const detail::getter<T>& g) {
+  inline const std::remove_reference_t<T>& get_property_value (const detail::getter<T>& g) {
     return g.value;
   }
 
@@ -183,13 +266,13 @@ namespace persistent {
     return a.value;
   }
 
-  template<typename T>
-  inline void set_property_value (detail::setter<T>& s, std::remove_const_t<std::remove_reference_t<T>>&& value) {
+  template<typename T, typename F>
+  inline void set_property_value (detail::setter<T, F>& s, typename detail::setter<T, F>::type&& value) {
     s.call(std::move(value));
   }
 
   // --------------------------------------------------------------------------
-  template<typename T>
+  template<typename T, typename Enable = void>
   struct convert {
 
     static inline std::string key_to_string (const T& k) {
@@ -217,6 +300,139 @@ namespace persistent {
     }
   };
 
+  /// strings with another allocator, as std::pmr::string, take the whole key
+  template<typename Traits, typename A>
+  struct convert<std::basic_string<char, Traits, A>> {
+    typedef std::basic_string<char, Traits, A> type;
+
+    static inline std::string key_to_string (const type& k) {
+      return std::string(k.data(), k.size());
+    }
+
+    static inline type string_to_key (const std::string& s) {
+      return type(s.data(), s.size());
+    }
+  };
+
+  /// numbers, except bool and characters
+  template<typename T>
+  struct is_number : std::integral_constant<bool, std::is_arithmetic<T>::value &&
+                                                       !std::is_same<T, bool>::value &&
+                                                       !std::is_same<T, char>::value &&
+                                                       !std::is_same<T, signed char>::value &&
+                                                       !std::is_same<T, unsigned char>::value &&
+                                                       !std::is_same<T, wchar_t>::value &&
+                                                       !std::is_same<T, char16_t>::value &&
+                                                       !std::is_same<T, char32_t>::value> {};
+
+  /// types with their own operator<< and operator>>
+  template<typename T, typename S = void>
+  struct has_stream_operators : std::false_type {};
+
+  template<typename T>
+  struct has_stream_operators<T, std::void_t<decltype(std::declval<std::ostream&>() << std::declval<const T&>()),
+                                             decltype(std::declval<std::istream&>() >> std::declval<T&>())>> : std::true_type {};
+
+  /// numeric keys and enum keys without stream operators are converted without a stream,
+  /// enums by their underlying value. Enums with stream operators keep their own format.
+  template<typename T>
+  struct convert<T, typename std::enable_if<is_number<T>::value ||
+                                            (std::is_enum<T>::value && !has_stream_operators<T>::value)>::type> {
+    typedef typename std::conditional<std::is_enum<T>::value, std::underlying_type<T>, std::common_type<T>>::type::type value_type;
+
+    static inline std::string key_to_string (const T& k) {
+      char buffer[32];
+      const auto r = std::to_chars(buffer, buffer + sizeof(buffer), static_cast<value_type>(k));
+      return std::string(buffer, r.ptr);
+    }
+
+    static inline T string_to_key (const std::string& s) {
+      value_type k = {};
+      const auto r = std::from_chars(s.data(), s.data() + s.size(), k);
+      if ((r.ec != std::errc()) || (r.ptr != s.data() + s.size())) {
+        throw std::runtime_error("Could not convert key '" + s + "'");
+      }
+      return static_cast<T>(k);
+    }
+  };
+
+  // --------------------------------------------------------------------------
+  //
+  // Map of key/value pairs in a vector sorted by key.
+  // Lookup is a binary search, appended elements are ordered by sort().
+  //
+  template<typename K, typename V, typename C = std::less<K>, typename A = std::allocator<std::pair<K, V>>>
+  class flat_map : public std::vector<std::pair<K, V>, A> {
+  public:
+    typedef std::vector<std::pair<K, V>, A> super;
+    typedef K key_type;
+    typedef V mapped_type;
+    typedef C key_compare;
+    typedef typename super::iterator iterator;
+    typedef typename super::const_iterator const_iterator;
+
+    flat_map () = default;
+
+    flat_map (std::initializer_list<std::pair<K, V>> l)
+      : super(l)
+    {
+      sort();
+    }
+
+    iterator lower_bound (const K& k) {
+      return std::lower_bound(super::begin(), super::end(), k, less());
+    }
+
+    const_iterator lower_bound (const K& k) const {
+      return std::lower_bound(super::begin(), super::end(), k, less());
+    }
+
+    iterator find (const K& k) {
+      iterator i = lower_bound(k);
+      return ((i != super::end()) && !C()(k, i->first)) ? i : super::end();
+    }
+
+    const_iterator find (const K& k) const {
+      const_iterator i = lower_bound(k);
+      return ((i != super::end()) && !C()(k, i->first)) ? i : super::end();
+    }
+
+    V& operator[] (const K& k) {
+      iterator i = lower_bound(k);
+      if ((i == super::end()) || C()(k, i->first)) {
+        i = super::emplace(i, k, V());
+      }
+      return i->second;
+    }
+
+    /// restore the order after appending elements, the last of equal keys is kept.
+    void sort () {
+      std::stable_sort(super::begin(), super::end(), [] (const std::pair<K, V>& l, const std::pair<K, V>& r) {
+        return C()(l.first, r.first);
+      });
+      if (super::empty()) {
+        return;
+      }
+      auto last = super::begin();
+      for (auto i = last + 1; i != super::end(); ++i) {
+        if (C()(last->first, i->first)) {
+          ++last;
+        }
+        if (last != i) {
+          *last = std::move(*i);
+        }
+      }
+      super::erase(last + 1, super::end());
+    }
+
+  private:
+    struct less {
+      bool operator() (const std::pair<K, V>& e, const K& k) const {
+        return C()(e.first, k);
+      }
+    };
+  };
+
   // --------------------------------------------------------------------------
 
 } // namespace persistent
@@ -0,0 +1,454 @@
+/**
+* @copyright (c) 2015-2021 Ing. Buero Rothfuss
+*                          Riedlinger Str. 8
+*                          70327 Stuttgart
+*                          Germany
+*                          http://www.rothfuss-web.de
+*
+* @author    <a href="mailto:armin@rothfuss-web.de">Armin Rothfuss</a>
+*
+* Project    persistent lib
+*
+* @brief     C++ struct persistence
+*
+* @license   MIT license. See accompanying file LICENSE.
+*/
+
+#pragma once
+
+// --------------------------------------------------------------------------
+//
+// Common includes
+//
+#include <memory_resource>
+#include <string_view>
+#include <charconv>
+#include <vector>
+#include <string>
+
+// --------------------------------------------------------------------------
+//
+// Project includes
+//
+#include "persistent_ios.h"
+
+
+namespace persistent {
+
+  namespace dom {
+
+    // --------------------------------------------------------------------------
+    //
+    // Node of a document tree. Key, value and the contiguous child array are
+    // allocated from the arena of the document.
+    //
+    struct node {
+      typedef std::pmr::polymorphic_allocator<std::byte> allocator_type;
+      typedef std::pmr::vector<node> children_type;
+
+      explicit node (const allocator_type& alloc = {})
+        : key(alloc)
+        , value(alloc)
+        , children(alloc)
+      {}
+
+      node (const node& rhs, const allocator_type& alloc)
+        : key(rhs.key, alloc)
+        , value(rhs.value, alloc)
+        , children(rhs.children, alloc)
+      {}
+
+      node (node&& rhs, const allocator_type& alloc)
+        : key(std::move(rhs.key), alloc)
+        , value(std::move(rhs.value), alloc)
+        , children(std::move(rhs.children), alloc)
+      {}
+
+      node (const node&) = default;
+      node (node&&) = default;
+      node& operator= (const node&) = default;
+      node& operator= (node&&) = default;
+
+      /// append a child with key.
+      node& add (std::string_view k) {
+        children.emplace_back().key.assign(k.data(), k.size());
+        return children.back();
+      }
+
+      /// the first child with key or nullptr.
+      node* find (std::string_view k) {
+        for (node& n : children) {
+          if (k == std::string_view(n.key)) {
+            return &n;
+          }
+        }
+        return nullptr;
+      }
+
+      std::size_t size () const {
+        return children.size();
+      }
+
+      bool empty () const {
+        return value.empty() && children.empty();
+      }
+
+      std::pmr::string key;
+      std::pmr::string value;
+      children_type children;
+    };
+
+    // --------------------------------------------------------------------------
+    //
+    // A document owns the arena of all its nodes. Nothing is released before
+    // the document is destroyed or cleared.
+    //
+    class document {
+    public:
+      explicit document (std::size_t initial_size = 4096)
+        : arena(initial_size)
+        , root_(&arena)
+      {}
+
+      document (const document&) = delete;
+      document& operator= (const document&) = delete;
+
+      node& root () {
+        return root_;
+      }
+
+      /// drop all nodes and release the arena.
+      void clear () {
+        root_ = node(&arena);
+        arena.release();
+      }
+
+    private:
+      std::pmr::monotonic_buffer_resource arena;
+      node root_;
+    };
+
+  } // namespace dom
+
+  namespace io {
+
+    // --------------------------------------------------------------------------
+    //
+    // write
+    //
+    // --------------------------------------------------------------------------
+
+    /// write value
+    template<typename T>
+    struct write_value_t<dom::node, T> {
+      static void to (dom::node& n, const T& t) {
+        if constexpr (std::is_arithmetic<T>::value) {
+          char buffer[32];
+          typedef typename std::conditional<std::is_same<std::remove_cv_t<T>, bool>::value, int, std::remove_cv_t<T>>::type value_type;
+          const auto r = std::to_chars(buffer, buffer + sizeof(buffer), static_cast<value_type>(t));
+          n.value.assign(buffer, r.ptr);
+        } else {
+          std::ostringstream os;
+          os << t;
+          n.value.assign(os.str());
+        }
+      }
+    };
+
+    template<>
+    struct write_value_t<dom::node, const std::string> {
+      static void to (dom::node& n, const std::string& t) {
+        n.value.assign(t.data(), t.size());
+      }
+    };
+
+    template<>
+    struct write_value_t<dom::node, const std::string_view> {
+      static void to (dom::node& n, const std::string_view& t) {
+        n.value.assign(t.data(), t.size());
+      }
+    };
+
+    template<>
+    struct write_value_t<dom::node, const char> {
+      static void to (dom::node& n, const char t) {
+        n.value.assign(1, t);
+      }
+    };
+
+    /// write property as child
+    template<typename T>
+    struct write_attribute_t<dom::node, T> {
+      static void to (dom::node& n, const T& t) {
+        write_any(n.add(get_property_name(t)), get_property_value(t));
+      }
+    };
+
+    /// write vector and array values
+    template<typename T, typename V>
+    struct writeList_t<dom::node, T, V> {
+      static void to (dom::node& n, const V& v) {
+        n.children.reserve(n.children.size() + v.size());
+        for (const T& t : v) {
+          write_any(n.add({}), t);
+        }
+      }
+    };
+
+    /// write pair
+    template<typename T1, typename T2>
+    struct write_pair_t<dom::node, T1, T2> {
+      static void to (dom::node& n, const std::pair<T1, T2>& v) {
+        n.children.reserve(n.children.size() + 2);
+        write_any(n.add({}), v.first);
+        write_any(n.add({}), v.second);
+      }
+    };
+
+    /// write map
+    template<typename M>
+    struct write_map_t<dom::node, M> {
+      static void to (dom::node& n, const M& m) {
+        n.children.reserve(n.children.size() + m.size());
+        for (const auto& e : m) {
+          write_any(n.add(convert<typename M::key_type>::key_to_string(e.first)), e.second);
+        }
+      }
+    };
+
+    /// write tagged value as tag and value
+    template<typename A>
+    struct write_tagged_t<dom::node, A> {
+      static void to (dom::node& n, const A& a) {
+        n.children.reserve(n.children.size() + 2);
+        write_any(n.add({}), a.tag());
+        a.write(n.add({}));
+      }
+    };
+
+    /// write tuple, elements are named by index
+    template<typename ... Types>
+    struct write_tuple_t<dom::node, Types...> {
+      static void to (dom::node& n, const std::tuple<Types...>& t) {
+        to(n, t, std::index_sequence_for<Types...>());
+      }
+
+      template<std::size_t ... I>
+      static void to (dom::node& n, const std::tuple<Types...>& t, std::index_sequence<I...>) {
+        n.children.reserve(n.children.size() + sizeof...(Types));
+        (write_any(n.add(std::to_string(I)), std::get<I>(t)), ...);
+      }
+    };
+
+    // --------------------------------------------------------------------------
+    //
+    // read
+    //
+    // --------------------------------------------------------------------------
+
+    template<>
+    struct parser<dom::node> {
+      static bool read_list_start (dom::node&) { return true; }
+      static bool read_list_element_init (dom::node&, int) { return true; }
+      static void read_list_element_finish (dom::node&) {}
+      static void read_list_end (dom::node&) {}
+
+      static void read_property_init (dom::node&, std::string&) {}
+      static void read_property_finish (dom::node&, const std::string&) {}
+
+      static bool read_next_struct_element (dom::node&, std::string&) { return false; }
+      static void read_struct_element_finish (dom::node&, const std::string&) {}
+
+      static bool is_ptr_empty (dom::node& n) {
+        return n.empty();
+      }
+
+      static void skip_value (dom::node&) {}
+    };
+
+    /// read value
+    template<typename T>
+    struct read_value_t<dom::node, T> {
+      static bool from (dom::node& n, T& t) {
+        const std::string_view v(n.value);
+        if constexpr (std::is_arithmetic<T>::value) {
+          typedef typename std::conditional<std::is_same<T, bool>::value, int, T>::type value_type;
+          value_type i = {};
+          const auto r = std::from_chars(v.data(), v.data() + v.size(), i);
+          if (r.ec != std::errc()) {
+            throw std::runtime_error(msg_fmt() << "Could not convert '" << v << "' to " << typeid(T).name());
+          }
+          t = static_cast<T>(i);
+          return true;
+        } else {
+          imemstream is(v.data(), v.size());
+          is >> t;
+          return true;
+        }
+      }
+    };
+
+    template<>
+    struct read_value_t<dom::node, std::string> {
+      static bool from (dom::node& n, std::string& t) {
+        t.assign(n.value.data(), n.value.size());
+        return true;
+      }
+    };
+
+    template<>
+    struct read_value_t<dom::node, char> {
+      static bool from (dom::node& n, char& t) {
+        t = n.value.empty() ? 0 : n.value.front();
+        return true;
+      }
+    };
+
+    /// read property from child
+    template<typename T>
+    struct read_attribute_t<dom::node, T> {
+      static bool from (dom::node& n, T& t) {
+        dom::node* child = n.find(get_property_name(t));
+        return child && read_property(*child, t);
+      }
+    };
+
+    /// read setter from child
+    template<typename T>
+    struct read_setter_t<dom::node, T> : public read_attribute_t<dom::node, T> {};
+
+    /// read vector
+    template<typename T, typename V>
+    struct read_vector_t<dom::node, T, V> {
+      static bool from (dom::node& n, V& v) {
+        std::size_t i = read_into_scope::active() ? 0 : v.size();
+        v.resize(i + n.size());
+        bool found = false;
+        for (dom::node& child : n.children) {
+          found |= read_any(child, v[i++]);
+        }
+        return found;
+      }
+    };
+
+    /// read array
+    template<typename T, typename A>
+    struct read_array_t<dom::node, T, A> {
+      static bool from (dom::node& n, A& a) {
+        bool found = false;
+        std::size_t i = 0;
+        for (dom::node& child : n.children) {
+          if (i == a.size()) {
+            break;
+          }
+          found |= read_any(child, a[i++]);
+        }
+        return found;
+      }
+    };
+
+    /// read pair
+    template<typename T1, typename T2>
+    struct read_pair_t<dom::node, T1, T2> {
+      static bool from (dom::node& n, std::pair<T1, T2>& v) {
+        if (n.size() != 2) {
+          throw std::runtime_error(msg_fmt() << "Expected to have 2 childs for pair but got " << n.size());
+        }
+        read_any(n.children.front(), v.first);
+        read_any(n.children.back(), v.second);
+        return true;
+      }
+    };
+
+    /// read tagged value
+    template<typename A>
+    struct read_tagged_t<dom::node, A> {
+      static bool from (dom::node& n, A& a) {
+        if (n.size() != 2) {
+          throw std::runtime_error(msg_fmt() << "Expected to have 2 childs for tagged value but got " << n.size());
+        }
+        std::size_t tag = 0;
+        read_any(n.children.front(), tag);
+        a.select(tag);
+        return a.read(n.children.back());
+      }
+    };
+
+    /// read map
+    template<typename M>
+    struct read_map_t<dom::node, M> {
+      static bool from (dom::node& n, M& m) {
+        typedef typename M::key_type K;
+        typedef typename M::mapped_type V;
+        std::string name;
+        bool found = false;
+        if (read_into_scope::active()) {
+          m.clear();
+        }
+        reserve(m, m.size() + n.size());
+        for (dom::node& child : n.children) {
+          name.assign(child.key.data(), child.key.size());
+          found |= read_any<dom::node, V>(child, map_inserter_t<M>::element(m, convert<K>::string_to_key(name)));
+        }
+        map_inserter_t<M>::finish(m);
+        return found;
+      }
+    };
+
+    /// read struct, unknown children are ignored
+    template<typename ... Types>
+    struct read_struct_t<dom::node, Types...> {
+      static bool from (dom::node& n, std::tuple<Types...>& t, bool* seen = nullptr) {
+        std::string name;
+        bool found = false;
+        for (dom::node& child : n.children) {
+          name.assign(child.key.data(), child.key.size());
+          found |= read_attributes_t<dom::node, Types...>::property(child, name, t, seen);
+        }
+        return found;
+      }
+    };
+
+    /// read tuple
+    template<typename ... Types>
+    struct read_tuple_t<dom::node, Types...> {
+      static bool from (dom::node& n, std::tuple<Types...>& t) {
+        return from(n, t, std::index_sequence_for<Types...>());
+      }
+
+      template<std::size_t ... I>
+      static bool from (dom::node& n, std::tuple<Types...>& t, std::index_sequence<I...>) {
+        bool found = false;
+        ((found |= element(n.find(std::to_string(I)), std::get<I>(t))), ...);
+        return found;
+      }
+
+      template<typename T>
+      static bool element (dom::node* child, T& t) {
+        return child && read_any(*child, t);
+      }
+    };
+
+  } // namespace io
+
+  // --------------------------------------------------------------------------
+  //
+  // Base for persistent structs with dom members, T is the derived struct.
+  //
+  template<typename T>
+  struct dom_struct : public persistent_struct {
+    typedef persistent_struct super;
+
+    void write (dom::node& n) const {
+      io::write(n, static_cast<const T&>(*this));
+    }
+
+    bool read (dom::node& n) {
+      return io::read(n, static_cast<T&>(*this));
+    }
+
+  };
+
+} // namespace persistent
+
+// --------------------------------------------------------------------------
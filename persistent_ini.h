@@ -22,6 +22,11 @@
 //
 #include <limits>
 #include <algorithm>
+#include <utility>
+#include <string_view>
+#include <charconv>
+#include <cstring>
+#include <thread>
 
 // --------------------------------------------------------------------------
 //
@@ -34,78 +39,179 @@ namespace persistent {
 
   namespace io {
 
+    /**
+     * Dotted ini key path.
+     * The elements are kept in one reused buffer and addressed by offset and length,
+     * so reading or building a path allocates no memory once the buffers are large enough.
+     */
     struct ini_path {
+      /// offset and length of an element
+      typedef std::pair<std::size_t, std::size_t> range;
 
       std::ostream& print (std::ostream& os) const {
-        bool first = true;
-        for (const auto& p : path) {
-          if(first) {
-            first = false;
-          } else {
+        if (!base) {
+          return os.write(buffer.data(), buffer.size());
+        }
+        for (std::size_t i = 0; i < size(); ++i) {
+          if (i > 0) {
             os << '.';
           }
-          os << p;
+          const auto e = element(i);
+          os.write(e.data(), e.size());
         }
         return os;
       }
 
+      /// read a key up to the '=', relative to the current section.
       void read_key (std::istream& is) {
-        path.clear();
-        char next = 0;
+        typedef std::char_traits<char> traits;
+        buffer.resize(section_length);
+        elements.resize(section_elements);
         is >> std::ws;
-        while (is.good() && (next != '=')) {
-          next = is.get();
-          std::ostringstream part;
-          while (is.good() && (next != '.') && (next != '=')) {
-            part.put(next);
-            next = is.get();
-          }
-          std::string key = part.str();
-          key.erase(key.find_last_not_of(" \t\n\r") + 1);
-          path.push_back(key);
+        if (section_elements > 0) {
+          buffer.push_back('.');
+        }
+        const std::size_t begin = buffer.size();
+        std::streambuf* buf = is.rdbuf();
+        auto c = buf->sbumpc();
+        for (; !traits::eq_int_type(c, traits::eof()) && (c != '='); c = buf->sbumpc()) {
+          buffer.push_back(traits::to_char_type(c));
+        }
+        if (traits::eq_int_type(c, traits::eof())) {
+          is.setstate(std::ios_base::eofbit);
+        }
+        split(buffer.data(), begin, buffer.size(), elements);
+      }
+
+      /// read a section header '[a.b.c]', following keys are relative to it.
+      void read_section (std::istream& is) {
+        clear();
+        is.ignore(1);
+        std::getline(is >> std::ws, buffer, ']');
+        if (!buffer.empty()) {
+          split(buffer.data(), 0, buffer.size(), elements);
+        }
+        section_length = buffer.size();
+        section_elements = elements.size();
+        is.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+      }
+
+      /// the path without the last element.
+      std::string_view parent () const {
+        if (elements.size() < 2) {
+          return {};
+        }
+        return std::string_view(buffer.data(), elements.back().first - 1);
+      }
+
+      /// the last element of the path.
+      std::string_view last () const {
+        if (elements.empty()) {
+          return {};
         }
+        return element(elements.size() - 1);
       }
 
       inline bool match (const ini_path& rhs) const {
-        return (this == &rhs) || rhs.path == path;
+        if ((this == &rhs)) {
+          return true;
+        }
+        if (size() != rhs.size()) {
+          return false;
+        }
+        for (std::size_t i = 0; i < size(); ++i) {
+          if (element(i) != rhs.element(i)) {
+            return false;
+          }
+        }
+        return true;
       }
 
       inline bool operator== (const ini_path& rhs) const {
         return match(rhs);
       }
 
-      const inline std::string& element (int i) const {
-        return path.at(i);
+      inline std::string_view element (std::size_t i) const {
+        const auto& e = elements.at(i);
+        return std::string_view((base ? base : buffer.data()) + e.first, e.second);
       }
 
       inline std::size_t size () const {
-        return path.size();
+        return elements.size();
       }
 
       bool is_parent_of (const ini_path& key) const {
-        typedef std::vector<std::string>::const_iterator it;
-        const it ke = key.path.end();
-        const it pe = path.end();
-        it p = path.begin();
-        it k = key.path.begin();
-        for (; (k < ke) && (p < pe); k++, p++) {
-          if (*k != *p) {
+        if (size() >= key.size()) {
+          return false;
+        }
+        for (std::size_t i = 0; i < size(); ++i) {
+          if (element(i) != key.element(i)) {
             return false;
           }
         }
-        return (p == pe) && (k != ke);
+        return true;
+      }
+
+      inline void push (std::string_view element) {
+        if (!elements.empty()) {
+          buffer.push_back('.');
+        }
+        elements.emplace_back(buffer.size(), element.size());
+        buffer.append(element.data(), element.size());
       }
 
-      inline void push (const std::string& element) {
-        path.push_back(element);
+      inline void push (std::size_t index) {
+        char str[24];
+        const auto result = std::to_chars(str, str + sizeof(str), index);
+        push(std::string_view(str, result.ptr - str));
       }
 
       inline void pop () {
-        path.pop_back();
+        const std::size_t begin = elements.back().first;
+        buffer.resize(begin > 0 ? begin - 1 : 0);
+        elements.pop_back();
+      }
+
+      inline void clear () {
+        buffer.clear();
+        elements.clear();
+        section_length = 0;
+        section_elements = 0;
+        base = nullptr;
+      }
+
+      /// use elements of an external buffer, added by append.
+      inline void assign (const char* data) {
+        clear();
+        base = data;
+      }
+
+      inline void append (const range& r) {
+        elements.push_back(r);
+      }
+
+      /// split data between begin and end at '.' into elements, trailing blanks are removed.
+      static void split (const char* data, std::size_t begin, std::size_t end, std::vector<range>& elements) {
+        while (begin <= end) {
+          std::size_t next = begin;
+          while ((next < end) && (data[next] != '.')) {
+            ++next;
+          }
+          std::size_t last = next;
+          while ((last > begin) && ::isspace(static_cast<unsigned char>(data[last - 1]))) {
+            --last;
+          }
+          elements.emplace_back(begin, last - begin);
+          begin = next + 1;
+        }
       }
 
     private:
-      std::vector<std::string> path;
+      std::string buffer;
+      std::vector<range> elements;
+      std::size_t section_length = 0;
+      std::size_t section_elements = 0;
+      const char* base = nullptr;
     };
 
     // --------------------------------------------------------------------------
@@ -118,14 +224,25 @@ namespace persistent {
     // specializations for ini formatted ostream
     //
     struct ini_formatter_context {
-      ini_formatter_context (std::ostream& os)
+      ini_formatter_context (std::ostream& os, bool sections = false)
         : os(os)
+        , sections(sections)
       {}
 
       ini_path path;
 
       std::ostream& print_path () {
-        return path.print(os) << '=';
+        if (!sections) {
+          return path.print(os) << '=';
+        }
+        const auto parent = path.parent();
+        if (parent != section) {
+          section.assign(parent.data(), parent.size());
+          os << '[' << section << ']';
+          endl();
+        }
+        const auto last = path.last();
+        return os.write(last.data(), last.size()) << '=';
       }
 
       void endl () {
@@ -133,8 +250,13 @@ namespace persistent {
       }
 
       std::ostream& os;
+      const bool sections;  /// group the keys by '[section]' headers
+      std::string section;
     };
 
+    template<>
+    struct table_driven<ini_formatter_context> : std::true_type {};
+
     template<>
     struct formatter<ini_formatter_context> {
 
@@ -156,7 +278,7 @@ namespace persistent {
       }
 
       static void write_list_element_init (ini_formatter_context& out, int num) {
-        out.path.push(std::to_string(num));
+        out.path.push(static_cast<std::size_t>(num));
       }
 
       static void write_list_element_finish (ini_formatter_context& out) {
@@ -202,8 +324,8 @@ namespace persistent {
     };
 
     template<typename T>
-    void write_ini (std::ostream& os, const T& t) {
-      ini_formatter_context out(os);
+    void write_ini (std::ostream& os, const T& t, bool sections = false) {
+      ini_formatter_context out(os, sections);
       write(out, t);
     }
 
@@ -216,12 +338,47 @@ namespace persistent {
         : is(is)
       {}
 
-      ini_path path;
       ini_path key;
+      std::size_t depth = 0;  /// number of key elements already resolved
+      std::string buffer;     /// reused buffer to convert key elements
       std::istream& is;
 
-      bool match() const {
-        return path == key;
+      /// all key elements are resolved.
+      bool match () const {
+        return depth == key.size();
+      }
+
+      /// the key has an unresolved element.
+      bool has_element () const {
+        return depth < key.size();
+      }
+
+      /// the next unresolved key element.
+      std::string_view element () const {
+        return key.element(depth);
+      }
+
+      /// the next unresolved key element as string.
+      const std::string& element_string () {
+        const auto e = element();
+        buffer.assign(e.data(), e.size());
+        return buffer;
+      }
+
+      /// true if the next unresolved key element is an index.
+      bool is_index () const {
+        const auto index = element();
+        return !index.empty() && std::all_of(index.begin(), index.end(), [] (char c) {
+          return ::isdigit(static_cast<unsigned char>(c));
+        });
+      }
+
+      /// the next unresolved key element as index.
+      std::size_t index () const {
+        const auto e = element();
+        std::size_t idx = 0;
+        std::from_chars(e.data(), e.data() + e.size(), idx);
+        return idx;
       }
 
       void skip_to_eol () {
@@ -256,52 +413,58 @@ namespace persistent {
       static void read_struct_element_finish (ini_parser_context&, const std::string&) {}
 
       static bool is_ptr_empty (ini_parser_context& in) {
+        if (in.has_element()) {
+          return false;
+        }
         in.skip_blank();
         const char next = in.is.peek();
         return (next == '\n') || (next == '\r');
       }
 
+      static void skip_value (ini_parser_context& in) {
+        in.skip_to_eol();
+      }
+
     };
 
     template<typename T>
     struct read_attribute_t<ini_parser_context, T> {
       static bool from (ini_parser_context& in, T& t) {
-        in.path.push(get_property_name(t));
-        const bool found = read_any(in, access_property_value(t));
-        in.path.pop();
-        return found;
+        if (in.has_element() && (in.element() == get_property_name(t))) {
+          ++in.depth;
+          const bool found = read_any(in, access_property_value(t));
+          --in.depth;
+          return found;
+        }
+        return false;
       }
     };
 
     template<typename T>
     struct read_setter_t<ini_parser_context, T> {
       static bool from (ini_parser_context& in, T& t) {
-        in.path.push(get_property_name(t));
-        typename T::type v = {};
-        bool found = false;
-        if (found = read_any(in, v)) {
-          set_property_value(t, std::move(v));
+        if (in.has_element() && (in.element() == get_property_name(t))) {
+          ++in.depth;
+          const bool found = read_property(in, t);
+          --in.depth;
+          return found;
         }
-        in.path.pop();
-        return found;
+        return false;
       }
     };
 
     template<typename T, typename V>
     struct read_vector_t<ini_parser_context, T, V> {
       static bool from (ini_parser_context& in, V& v) {
-        if (in.path.is_parent_of(in.key)) {
-          const std::string& index = in.key.element(in.path.size());
-          if (std::all_of(index.begin(), index.end(), ::isdigit)) {
-            in.path.push(index);
-            const int idx = std::stoi(index);
-            if (v.size() < idx + 1) {
-              v.resize(idx + 1);
-            }
-            const bool found = read_any(in, v.at(idx));
-            in.path.pop();
-            return found;
+        if (in.has_element() && in.is_index()) {
+          const std::size_t idx = in.index();
+          if (v.size() < idx + 1) {
+            v.resize(idx + 1);
           }
+          ++in.depth;
+          const bool found = read_any(in, v.at(idx));
+          --in.depth;
+          return found;
         }
         return false;
       }
@@ -310,66 +473,224 @@ namespace persistent {
     template<typename T, typename A>
     struct read_array_t<ini_parser_context, T, A> {
       static bool from (ini_parser_context& in, A& a) {
-        if (in.path.is_parent_of(in.key)) {
-          const std::string& index = in.key.element(in.path.size());
-          if (std::all_of(index.begin(), index.end(), ::isdigit)) {
-            in.path.push(index);
-            const int idx = std::stoi(index);
-            const bool found = read_any(in, a.at(idx));
-            in.path.pop();
-            return found;
-          }
+        if (in.has_element() && in.is_index()) {
+          const std::size_t idx = in.index();
+          ++in.depth;
+          const bool found = read_any(in, a.at(idx));
+          --in.depth;
+          return found;
         }
         return false;
       }
     };
 
-    template<typename K, typename V, typename C, typename A>
-    struct read_map_t<ini_parser_context, K, V, C, A> {
-      static bool from (ini_parser_context& in, std::map<K, V, C, A>& m) {
-        if (in.path.is_parent_of(in.key)) {
-          const std::string& index = in.key.element(in.path.size());
-          in.path.push(index);
-          const bool found = read_any(in, m[index]);
-          in.path.pop();
+    template<typename S>
+    struct read_set_t<ini_parser_context, S> {
+      static bool from (ini_parser_context& in, S& s) {
+        if (in.has_element() && in.is_index()) {
+          typename S::value_type v = {};
+          ++in.depth;
+          const bool found = read_any(in, v);
+          --in.depth;
+          if (found) {
+            s.insert(std::move(v));
+          }
           return found;
         }
         return false;
       }
     };
 
-    template<typename ... Types>
-    struct read_struct_t<ini_parser_context, Types...> {
-      static bool from (ini_parser_context& in, std::tuple<Types...>& t) {
-        if (in.path.is_parent_of(in.key)) {
-          const std::string& index = in.key.element(in.path.size());
-          in.path.push(index);
-          const bool found = read_attributes_t<sizeof...(Types), ini_parser_context, Types...>::property(in, index, t);
-          in.path.pop();
+    template<typename M>
+    struct read_map_t<ini_parser_context, M> {
+      static bool from (ini_parser_context& in, M& m) {
+        if (in.has_element()) {
+          typename M::mapped_type& v = m[convert<typename M::key_type>::string_to_key(in.element_string())];
+          ++in.depth;
+          const bool found = read_any(in, v);
+          --in.depth;
           return found;
         }
         return false;
       }
     };
 
+    namespace ini {
+
+      /// the object the value of a key=value line is read into, resolved ahead of the read
+      struct target {
+        bool (*read) (ini_parser_context&, void*);  /// reader of the object, nullptr for an unknown key
+        void* object;                               /// the object reached by the resolved key elements
+        std::size_t depth;                          /// number of resolved key elements
+      };
+
+      template<typename M>
+      inline bool read_to (ini_parser_context& in, void* object) {
+        return read_any(in, *static_cast<M*>(object));
+      }
+
+      template<typename M>
+      void resolve (const ini_path& key, std::size_t depth, M& m, target& r);
+
+    } // namespace ini
+
+    /**
+     * Index of the attribute names of a persistent struct, build once per type.
+     * Maps each name to the reader of the corresponding attribute, so a key
+     * element is resolved by a lookup instead of comparing all attribute names.
+     * Plain members are read through their offset in the struct, only getters,
+     * setters and attributes outside of the struct rebuild the attributes tuple.
+     */
+    template<typename T>
+    struct ini_index {
+      struct entry {
+        bool (*member) (ini_parser_context&, void*);  /// reader of the plain member at offset
+        bool (*element) (ini_parser_context&, T&);    /// reader of the attribute, if not a plain member
+        void (*resolve) (const ini_path&, std::size_t, void*, ini::target&);  /// resolver of the plain member
+        std::size_t offset;                           /// offset of the plain member in T
+      };
+
+      typedef std::multimap<std::string, entry, std::less<>> map;
+      static constexpr std::size_t size = std::tuple_size<decltype(persistent::attributes(std::declval<T&>()))>::value;
+
+      static const map& get (T& t) {
+        static const map index = build(t, std::make_index_sequence<size>{});
+        return index;
+      }
+
+      /// read the attribute of entry e from t
+      static bool read (ini_parser_context& in, T& t, const entry& e) {
+        return e.member ? e.member(in, reinterpret_cast<char*>(&t) + e.offset) : e.element(in, t);
+      }
+
+      /**
+       * resolve the key elements from depth on through the plain members of t.
+       * Resolving stops at the first element that is not a plain persistent struct
+       * member, or that has more than one attribute with its name.
+       */
+      static void resolve (const ini_path& key, std::size_t depth, T& t, ini::target& r) {
+        r = { &ini::read_to<T>, &t, depth };
+        if (depth >= key.size()) {
+          return;
+        }
+        const auto range = get(t).equal_range(key.element(depth));
+        if (range.first == range.second) {
+          r.read = nullptr;
+          return;
+        }
+        const entry& e = range.first->second;
+        if (e.member && (std::next(range.first) == range.second)) {
+          e.resolve(key, depth + 1, reinterpret_cast<char*>(&t) + e.offset, r);
+        }
+      }
+
+    private:
+      template<std::size_t ... I>
+      static map build (T& t, std::index_sequence<I...>) {
+        auto attr = persistent::attributes(t);
+        map index;
+        (index.emplace(get_property_name(std::get<I>(attr)), make_entry<I>(std::get<I>(attr), t)), ...);
+        return index;
+      }
+
+      template<std::size_t I, typename A>
+      static entry make_entry (const A& a, T& t) {
+        typedef typename field_type<A>::type M;
+        if constexpr (!std::is_void<M>::value) {
+          const char* base = reinterpret_cast<const char*>(&t);
+          const char* member = reinterpret_cast<const char*>(std::addressof(a.value));
+          if ((member >= base) && (member + sizeof(M) <= base + sizeof(T))) {
+            return { &ini::read_to<M>, nullptr, &resolve_member<M>, static_cast<std::size_t>(member - base) };
+          }
+        }
+        return { nullptr, &read_element<I>, nullptr, 0 };
+      }
+
+      template<typename M>
+      static void resolve_member (const ini_path& key, std::size_t depth, void* member, ini::target& r) {
+        ini::resolve(key, depth, *static_cast<M*>(member), r);
+      }
+
+      template<std::size_t I>
+      static bool read_element (ini_parser_context& in, T& t) {
+        auto attr = persistent::attributes(t);
+        return read_property(in, std::get<I>(attr));
+      }
+    };
+
+    namespace ini {
+
+      /// resolve the key elements from depth on, as far as possible without reading
+      template<typename M>
+      inline void resolve (const ini_path& key, std::size_t depth, M& m, target& r) {
+        if constexpr (is_persistent<M>::value) {
+          ini_index<M>::resolve(key, depth, m, r);
+        } else {
+          r = { &read_to<M>, &m, depth };
+        }
+      }
+
+    } // namespace ini
+
+    /// detect struct
+    template<typename T>
+    struct read_any_t<ini_parser_context, T, typename std::enable_if<is_persistent<T>::value>::type> {
+      static bool from (ini_parser_context& in, T& t) {
+        if (!in.has_element()) {
+          return false;
+        }
+        const auto range = ini_index<T>::get(t).equal_range(in.element());
+        bool found = false;
+        ++in.depth;
+        for (auto i = range.first; !found && (i != range.second); ++i) {
+          found = ini_index<T>::read(in, t, i->second);
+        }
+        --in.depth;
+        return found;
+      }
+    };
+
     template<typename T1, typename T2>
     struct read_pair_t<ini_parser_context, T1, T2> {
       static bool from (ini_parser_context& in, std::pair<T1, T2>& p) {
-        if (in.path.is_parent_of(in.key)) {
-          const std::string& index = in.key.element(in.path.size());
-          if (std::all_of(index.begin(), index.end(), ::isdigit)) {
-            in.path.push(index);
-            const int idx = std::stoi(index);
-            bool found = false;
-            switch (idx) {
-              case 0: found = read_any(in, p.first); break;
-              case 1: found = read_any(in, p.second); break;
-              default:
-                throw std::runtime_error(msg_fmt() << "Unexpected index " << idx << " for pair '" << in.key << "' expected [0, 1]");
+        if (in.has_element() && in.is_index()) {
+          const std::size_t idx = in.index();
+          bool found = false;
+          ++in.depth;
+          switch (idx) {
+            case 0: found = read_any(in, p.first); break;
+            case 1: found = read_any(in, p.second); break;
+            default:
+              throw std::runtime_error(msg_fmt() << "Unexpected index " << idx << " for pair '" << in.key << "' expected [0, 1]");
+          }
+          --in.depth;
+          return found;
+        }
+        return false;
+      }
+    };
+
+    template<typename A>
+    struct read_tagged_t<ini_parser_context, A> {
+      static bool from (ini_parser_context& in, A& a) {
+        if (in.has_element() && in.is_index()) {
+          const std::size_t idx = in.index();
+          bool found = false;
+          ++in.depth;
+          switch (idx) {
+            case 0: {
+              std::size_t tag = 0;
+              if ((found = read_any(in, tag))) {
+                a.select(tag);
+              }
+              break;
             }
-            in.path.pop();
-            return found;
+            case 1: found = a.read(in); break;
+            default:
+              throw std::runtime_error(msg_fmt() << "Unexpected index " << idx << " for tagged value '" << in.key << "' expected [0, 1]");
           }
+          --in.depth;
+          return found;
         }
         return false;
       }
@@ -422,11 +743,21 @@ namespace persistent {
       bool found = false;
       int line_no = 1;
       while (is.good()) {
-        if (is.peek() == '#') {
-          std::string comment;
-          std::getline(is, comment);
+        const char next = is.peek();
+        if ((next == '#') || (next == ';')) {
+          in.skip_to_eol();
+          is >> std::ws;
+          ++line_no;
+          continue;
+        }
+        if (next == '[') {
+          in.key.read_section(is);
+          is >> std::ws;
+          ++line_no;
+          continue;
         }
         in.key.read_key(is);
+        in.depth = 0;
         if (!read(in, t)) {
           // nothing read -> unknown key
          std::cerr << "Key '";
@@ -446,6 +777,214 @@ namespace persistent {
       return found;
     }
 
+    /// read with the strings, containers and pointees created by the read allocated from resource.
+    template<typename T>
+    bool read_ini (std::istream& is, T& t, std::pmr::memory_resource* resource, const std::string& filename = {}) {
+      memory_scope scope(resource);
+      return read_ini(is, t, filename);
+    }
+
+    // --------------------------------------------------------------------------
+    //
+    // parallel ini reader for large files
+    //
+    namespace ini {
+
+      const std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+      /// chunks are not split below this size
+      const std::size_t min_chunk_size = 64 * 1024;
+
+      /// element ranges of a section header
+      struct section {
+        std::size_t first;  /// first element range
+        std::size_t count;  /// number of element ranges
+      };
+
+      /// a key=value line
+      struct line {
+        std::size_t line_no;  /// line number inside the chunk
+        std::size_t section;  /// section inside the chunk, npos to use the current section of the previous chunks
+        std::size_t first;    /// first element range
+        std::size_t count;    /// number of element ranges
+        std::size_t value;    /// offset of the value, npos if the line has no '='
+        std::size_t end;      /// offset behind the line
+      };
+
+      /// the pre-parsed lines of a part of the file
+      struct chunk {
+        std::vector<ini_path::range> ranges;
+        std::vector<section> sections;
+        std::vector<line> lines;
+        std::vector<target> targets;  /// the resolved target of each line
+        std::size_t line_count = 0;
+        const chunk* previous = nullptr;  /// chunk of the section in effect at the begin of this chunk
+        std::size_t previous_section = 0;
+
+        /// the key of line l, relative to its section.
+        void key (ini_path& path, const char* data, const line& l) const {
+          path.assign(data);
+          const chunk* sc = (l.section == npos) ? previous : this;
+          if (sc) {
+            const ini::section& s = sc->sections[(l.section == npos) ? previous_section : l.section];
+            for (std::size_t i = 0; i < s.count; ++i) {
+              path.append(sc->ranges[s.first + i]);
+            }
+          }
+          for (std::size_t i = 0; i < l.count; ++i) {
+            path.append(ranges[l.first + i]);
+          }
+        }
+
+        /// resolve the keys of all lines through the members of t.
+        template<typename T>
+        void resolve (const char* data, T& t) {
+          ini_path path;
+          targets.resize(lines.size());
+          for (std::size_t i = 0; i < lines.size(); ++i) {
+            const line& l = lines[i];
+            if (l.value == npos) {
+              targets[i] = { nullptr, nullptr, 0 };
+            } else {
+              key(path, data, l);
+              ini::resolve(path, 0, t, targets[i]);
+            }
+          }
+        }
+
+        /// split the lines between begin and end, split the keys and section headers into elements.
+        void scan (const char* data, std::size_t begin, std::size_t end) {
+          while (begin < end) {
+            const char* nl = static_cast<const char*>(std::memchr(data + begin, '\n', end - begin));
+            const std::size_t eol = nl ? nl - data : end;
+            const std::size_t next = nl ? eol + 1 : end;
+            std::size_t p = begin;
+            while ((p < eol) && ::isspace(static_cast<unsigned char>(data[p]))) {
+              ++p;
+            }
+            if ((p < eol) && (data[p] == '[')) {
+              const char* close = static_cast<const char*>(std::memchr(data + p, ']', eol - p));
+              std::size_t b = p + 1;
+              const std::size_t e = close ? close - data : eol;
+              while ((b < e) && ::isspace(static_cast<unsigned char>(data[b]))) {
+                ++b;
+              }
+              section s = { ranges.size(), 0 };
+              if (b < e) {
+                ini_path::split(data, b, e, ranges);
+              }
+              s.count = ranges.size() - s.first;
+              sections.push_back(s);
+            } else if ((p < eol) && (data[p] != '#') && (data[p] != ';')) {
+              const char* eq = static_cast<const char*>(std::memchr(data + p, '=', eol - p));
+              line l = { line_count, sections.empty() ? npos : sections.size() - 1, ranges.size(), 0, npos, next };
+              ini_path::split(data, p, eq ? eq - data : eol, ranges);
+              l.count = ranges.size() - l.first;
+              if (eq) {
+                l.value = eq - data + 1;
+              }
+              lines.push_back(l);
+            }
+            ++line_count;
+            begin = next;
+          }
+        }
+      };
+
+    } // namespace ini
+
+    /**
+     * Read a large ini file.
+     * The file is mapped and split at line boundaries into chunks. The lines and keys of
+     * each chunk are scanned on its own thread, then the keys are resolved on the same
+     * threads to the members they are read into. Only the values are assigned afterwards
+     * in file order, so the last occurrence of a key wins as with read_ini.
+     * Key elements behind a container or a setter are resolved while assigning.
+     * Unknown keys are reported together after reading.
+     */
+    template<typename T>
+    bool read_ini_parallel (const std::string& filename, T& t, unsigned threads = std::thread::hardware_concurrency()) {
+      mapped_file file(filename);
+      const char* data = file.data();
+      const std::size_t size = file.size();
+
+      const std::size_t count = std::max<std::size_t>(1, std::min<std::size_t>(threads, size / ini::min_chunk_size));
+      std::vector<std::size_t> bounds(count + 1, size);
+      bounds[0] = 0;
+      for (std::size_t i = 1; i < count; ++i) {
+        const std::size_t b = std::max(bounds[i - 1], size / count * i);
+        const char* nl = static_cast<const char*>(std::memchr(data + b, '\n', size - b));
+        bounds[i] = nl ? nl - data + 1 : size;
+      }
+
+      std::vector<ini::chunk> chunks(count);
+      auto parallel = [&] (auto fn) {
+        std::vector<std::thread> workers;
+        for (std::size_t i = 1; i < count; ++i) {
+          workers.emplace_back(fn, i);
+        }
+        fn(0);
+        for (auto& w : workers) {
+          w.join();
+        }
+      };
+
+      parallel([&] (std::size_t i) {
+        chunks[i].scan(data, bounds[i], bounds[i + 1]);
+      });
+
+      for (std::size_t i = 1; i < count; ++i) {
+        const ini::chunk& p = chunks[i - 1];
+        if (p.sections.empty()) {
+          chunks[i].previous = p.previous;
+          chunks[i].previous_section = p.previous_section;
+        } else {
+          chunks[i].previous = &p;
+          chunks[i].previous_section = p.sections.size() - 1;
+        }
+      }
+
+      parallel([&] (std::size_t i) {
+        chunks[i].resolve(data, t);
+      });
+
+      imemstream is(data, data);
+      ini_parser_context in(is);
+      std::ostringstream unknown;
+      bool found = false;
+      std::size_t line_no = 1;
+      for (const ini::chunk& c : chunks) {
+        for (std::size_t i = 0; i < c.lines.size(); ++i) {
+          const ini::line& l = c.lines[i];
+          const ini::target& r = c.targets[i];
+          c.key(in.key, data, l);
+          bool read = false;
+          if (r.read) {
+            in.depth = r.depth;
+            is.reset(data + l.value, data + l.end);
+            read = r.read(in, r.object);
+          }
+          if (read) {
+            found = true;
+          } else {
+            // nothing read -> unknown key
+            unknown << "Key '";
+            in.key.print(unknown);
+            unknown << "' was not found at line " << (line_no + l.line_no);
+            if (!filename.empty()) {
+              unknown << " in file '" << filename << "'";
+            }
+            unknown << '\n';
+          }
+        }
+        line_no += c.line_count;
+      }
+      if (unknown.tellp() > 0) {
+        std::cerr << unknown.str() << std::flush;
+      }
+      return found;
+    }
+
 
   } // namespace io
 
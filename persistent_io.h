@@ -21,9 +21,17 @@
 // Common includes
 //
 #include <vector>
+#include <array>
 #include <map>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
 #include <sstream>
 #include <memory>
+#include <optional>
+#include <variant>
+#include <typeindex>
+#include <memory_resource>
 
 // --------------------------------------------------------------------------
 //
@@ -51,6 +59,52 @@ namespace persistent {
       std::ostringstream buffer;
     };
 
+    // --------------------------------------------------------------------------
+    //
+    // container traits
+    //
+    // --------------------------------------------------------------------------
+
+    /// detect key/value containers, written as struct with the keys as names
+    template<typename T>
+    struct is_map : std::false_type {};
+
+    template<typename K, typename V, typename C, typename A>
+    struct is_map<std::map<K, V, C, A>> : std::true_type {};
+
+    template<typename K, typename V, typename H, typename E, typename A>
+    struct is_map<std::unordered_map<K, V, H, E, A>> : std::true_type {};
+
+    template<typename K, typename V, typename C, typename A>
+    struct is_map<flat_map<K, V, C, A>> : std::true_type {};
+
+    /// detect set containers, written as list
+    template<typename T>
+    struct is_set : std::false_type {};
+
+    template<typename K, typename C, typename A>
+    struct is_set<std::set<K, C, A>> : std::true_type {};
+
+    template<typename K, typename H, typename E, typename A>
+    struct is_set<std::unordered_set<K, H, E, A>> : std::true_type {};
+
+    /// detect containers and strings with a polymorphic allocator
+    template<typename C, typename S = void>
+    struct uses_pmr : std::false_type {};
+
+    template<typename C>
+    struct uses_pmr<C, std::void_t<typename C::allocator_type>>
+      : std::integral_constant<bool, std::is_same<typename C::allocator_type, std::pmr::polymorphic_allocator<typename C::value_type>>::value &&
+                                     std::is_constructible<C, typename C::allocator_type>::value> {};
+
+    /// strings with other than the standard allocator
+    template<typename T>
+    struct is_alloc_string : std::false_type {};
+
+    template<typename A>
+    struct is_alloc_string<std::basic_string<char, std::char_traits<char>, A>>
+      : std::integral_constant<bool, !std::is_same<A, std::allocator<char>>::value> {};
+
     // --------------------------------------------------------------------------
     //
     // write
@@ -166,10 +220,23 @@ namespace persistent {
       write_array_t<Target, T, S>::to(out, t);
     }
 
+    /// write set values
+    template<typename Target, typename S>
+    struct write_set_t {
+      static void to (Target& out, const S& s) {
+        writeList_t<Target, typename S::value_type, S>::to(out, s);
+      }
+    };
+
+    template<typename Target, typename S>
+    void write_set (Target& out, const S& s) {
+      write_set_t<Target, S>::to(out, s);
+    }
+
     /// write key/value pair map
-    template<typename Target, typename K, typename V, typename C, typename A>
+    template<typename Target, typename M>
     struct write_map_t {
-      static void to (Target& out, const std::map<K, V, C, A>& m) {
+      static void to (Target& out, const M& m) {
         formatter<Target>::write_struct_start(out);
         bool first = true;
         for (const auto& e : m) {
@@ -178,7 +245,7 @@ namespace persistent {
           } else {
             formatter<Target>::write_members_delemiter(out);
           }
-          auto key = convert<K>::key_to_string(e.first);
+          auto key = convert<typename M::key_type>::key_to_string(e.first);
           formatter<Target>::write_property_init(out, key);
           write_any(out, e.second);
           formatter<Target>::write_property_finish(out, key);
@@ -187,29 +254,30 @@ namespace persistent {
       }
     };
 
-    template<typename Target, typename K, typename V, typename C, typename A>
-    void write_map (Target& out, const std::map<K, V, C, A>& m) {
-      write_map_t<Target, K, V, C, A>::to(out, m);
+    template<typename Target, typename M>
+    void write_map (Target& out, const M& m) {
+      write_map_t<Target, M>::to(out, m);
     }
 
     /**
-    * write recursive all elements of a tuple
+    * write all elements of a tuple, separated by the members delimiter
     */
-    template<std::size_t I, typename Target, typename... Types>
+    template<typename Target, typename... Types>
     struct write_attributes_t {
-      static void to (Target& out, std::tuple<const Types...> const& t) {
-        write_attributes_t<I - 1, Target, Types...>::to(out, t);
-        formatter<Target>::write_members_delemiter(out);
-        const auto& m = std::get<I>(t);
-        write_any(out, m);
+      static void to (Target& out, const std::tuple<Types...>& t) {
+        to(out, t, std::index_sequence_for<Types...>());
       }
-    };
 
-    /// end recursion at 0 elemnt.
-    template<typename Target, typename... Types>
-    struct write_attributes_t<0, Target, Types...> {
-      static void to (Target& out, std::tuple<const Types...> const& t) {
-        const auto& m = std::get<0>(t);
+      template<std::size_t ... I>
+      static void to (Target& out, const std::tuple<Types...>& t, std::index_sequence<I...>) {
+        (element<I>(out, std::get<I>(t)), ...);
+      }
+
+      template<std::size_t I, typename T>
+      static void element (Target& out, const T& m) {
+        if constexpr (I > 0) {
+          formatter<Target>::write_members_delemiter(out);
+        }
         write_any(out, m);
       }
     };
@@ -219,7 +287,7 @@ namespace persistent {
     struct write_struct_t {
       static void to (Target& out, const std::tuple<Types...>& t) {
         formatter<Target>::write_struct_start(out);
-        write_attributes_t<(sizeof...(Types)) - 1, Target, Types...>::to(out, t);
+        write_attributes_t<Target, Types...>::to(out, t);
         formatter<Target>::write_struct_end(out);
       }
     };
@@ -229,16 +297,520 @@ namespace persistent {
       write_struct_t<Target, Types...>::to(out, t);
     }
 
-    /// write shared values
+    /**
+     * contexts that read and write structs with the generic struct and attribute hooks.
+     * Structs are written and read table driven for these contexts.
+     */
+    template<typename Context>
+    struct table_driven : std::false_type {};
+
+    /// rendered start and end of a property
+    struct key_fragment {
+      std::string init;
+      std::string finish;
+    };
+
+    /**
+     * key fragments of a table driven context, rendered once per struct type and member
+     * in a compact and a beautified variant. Contexts that render their keys specialize
+     * this with rendered = true, render and write_property_init/finish taking the fragment.
+     */
+    template<typename Context>
+    struct key_fragments {
+      static constexpr bool rendered = false;
+    };
+
+    /// member type of a plain attribute, void for getter and setter
+    template<typename A>
+    struct field_type {
+      typedef void type;
+    };
+
+    template<typename T>
+    struct field_type<detail::attribute<T>> {
+      typedef T type;
+    };
+
+    /**
+     * field table of a persistent struct, build once per type from the first instance.
+     * A field is the name and the offset of a member, the members are written and read
+     * through tables of functions per context. Structs with getters or setters are not
+     * table driven, decided at compile time by plain. Members outside of the struct are
+     * accessed through the attributes tuple.
+     */
+    template<typename T, typename Attributes = decltype(persistent::attributes(std::declval<T&>()))>
+    struct field_table;
+
+    template<typename T, typename ... Types>
+    struct field_table<T, std::tuple<Types...>> {
+      static constexpr std::size_t size = sizeof...(Types);
+      static constexpr bool plain = (!std::is_void<typename field_type<Types>::type>::value && ...);
+
+      struct field {
+        std::string name;
+        std::size_t offset;
+        bool inside;            /// member is part of the struct, else accessed through the attributes
+        std::size_t first;      /// first field with the same name
+        std::size_t next;       /// next field with the same name or size
+      };
+
+      /// the table of T
+      static const field_table& get (const T& t) {
+        static const field_table table(t);
+        return table;
+      }
+
+      /// index of the field with name, searched from the expected index first
+      std::size_t find (std::string_view name, std::size_t expected) const {
+        for (std::size_t n = 0; n < size; ++n) {
+          const std::size_t i = (expected + n) % size;
+          if (fields[i].name == name) {
+            return i;
+          }
+        }
+        return size;
+      }
+
+      /// address of the member of field i in t
+      char* member (T& t, std::size_t i) const {
+        typedef char* (*accessor) (T&);
+        static const accessor* const outside = accessors(std::index_sequence_for<Types...>());
+        return fields[i].inside ? reinterpret_cast<char*>(&t) + fields[i].offset : outside[i](t);
+      }
+
+      const char* member (const T& t, std::size_t i) const {
+        return member(const_cast<T&>(t), i);
+      }
+
+      template<typename Target>
+      void write (Target& out, const T& t) const {
+        typedef void (*writer) (Target&, const char*);
+        static constexpr writer writers[] = { &write_field<Target, typename field_type<Types>::type>... };
+        formatter<Target>::write_struct_start(out);
+        for (std::size_t i = 0; i < size; ++i) {
+          if (i) {
+            formatter<Target>::write_members_delemiter(out);
+          }
+          if constexpr (key_fragments<Target>::rendered) {
+            const key_fragment& key = keys<Target>(out.beautify)[i];
+            key_fragments<Target>::write_property_init(out, key);
+            writers[i](out, member(t, i));
+            key_fragments<Target>::write_property_finish(out, key);
+          } else {
+            formatter<Target>::write_property_init(out, fields[i].name);
+            writers[i](out, member(t, i));
+            formatter<Target>::write_property_finish(out, fields[i].name);
+          }
+        }
+        formatter<Target>::write_struct_end(out);
+      }
+
+      /// the key fragments of the fields, rendered on first use
+      template<typename Target>
+      const key_fragment* keys (bool beautify) const {
+        static const std::array<key_fragment, 2 * size> rendered = render<Target>();
+        return rendered.data() + (beautify ? size : 0);
+      }
+
+      field fields[size];
+
+    private:
+      explicit field_table (const T& t) {
+        build(persistent::attributes(t), reinterpret_cast<const char*>(&t), std::index_sequence_for<Types...>());
+      }
+
+      template<std::size_t ... I>
+      void build (const std::tuple<Types...>& attr, const char* base, std::index_sequence<I...>) {
+        (add(I, std::get<I>(attr), base), ...);
+        // duplicate names are chained in declaration order, the first one that reads a value wins
+        for (std::size_t i = 0; i < size; ++i) {
+          fields[i].first = i;
+          fields[i].next = size;
+          for (std::size_t j = 0; j < i; ++j) {
+            if (fields[j].name == fields[i].name) {
+              fields[i].first = fields[j].first;
+              fields[j].next = (fields[j].next == size) ? i : fields[j].next;
+            }
+          }
+        }
+      }
+
+      template<typename M>
+      void add (std::size_t i, const detail::attribute<M>& a, const char* base) {
+        const char* member = reinterpret_cast<const char*>(std::addressof(a.value));
+        fields[i].name = a.name;
+        fields[i].offset = static_cast<std::size_t>(member - base);
+        fields[i].inside = (member >= base) && (member + sizeof(M) <= base + sizeof(T));
+      }
+
+      template<std::size_t ... I>
+      static const auto* accessors (std::index_sequence<I...>) {
+        typedef char* (*accessor) (T&);
+        static constexpr accessor table[] = { &access<I>... };
+        return table;
+      }
+
+      template<std::size_t I>
+      static char* access (T& t) {
+        return const_cast<char*>(reinterpret_cast<const char*>(std::addressof(std::get<I>(persistent::attributes(t)).value)));
+      }
+
+      template<typename Target>
+      std::array<key_fragment, 2 * size> render () const {
+        std::array<key_fragment, 2 * size> r;
+        for (std::size_t i = 0; i < size; ++i) {
+          r[i] = key_fragments<Target>::render(fields[i].name, false);
+          r[size + i] = key_fragments<Target>::render(fields[i].name, true);
+        }
+        return r;
+      }
+
+      template<typename Target, typename M>
+      static void write_field (Target& out, const char* member) {
+        write_any(out, *reinterpret_cast<const M*>(member));
+      }
+    };
+
+    /**
+     * scope of identity preserving shared pointers.
+     * While a scope exists, the shared pointers written or read by the current thread keep
+     * their identity: a shared object is written once as list of an id and its value, later
+     * occurrences as list of the id and an empty pointer. Reading rebuilds the sharing.
+     * Shared objects must be referenced through the same pointer type.
+     */
+    class shared_scope {
+    public:
+      shared_scope ()
+        : previous(current())
+      {
+        current() = this;
+      }
+
+      ~shared_scope () {
+        current() = previous;
+      }
+
+      shared_scope (const shared_scope&) = delete;
+      shared_scope& operator= (const shared_scope&) = delete;
+
+      /// the innermost scope of the current thread or nullptr
+      static shared_scope* active () {
+        return current();
+      }
+
+      /// id of the object at p and true if it is written the first time
+      std::pair<std::size_t, bool> write_id (const void* p) {
+        const auto i = written.emplace(p, written.size());
+        return { i.first->second, i.second };
+      }
+
+      /// the object read with id or an empty pointer
+      std::shared_ptr<void> find (std::size_t id) const {
+        const auto i = objects.find(id);
+        return i != objects.end() ? i->second : nullptr;
+      }
+
+      void add (std::size_t id, std::shared_ptr<void> p) {
+        objects[id] = std::move(p);
+      }
+
+    private:
+      static shared_scope*& current () {
+        static thread_local shared_scope* scope = nullptr;
+        return scope;
+      }
+
+      shared_scope* previous;
+      std::unordered_map<const void*, std::size_t> written;
+      std::unordered_map<std::size_t, std::shared_ptr<void>> objects;
+    };
+
+    /**
+     * scope of a memory resource for reads.
+     * While a scope exists, the pointees created and the empty pmr containers and
+     * strings filled by reads of the current thread are allocated from the resource.
+     */
+    class memory_scope {
+    public:
+      explicit memory_scope (std::pmr::memory_resource* resource)
+        : resource(resource)
+        , previous(current())
+      {
+        current() = this;
+      }
+
+      ~memory_scope () {
+        current() = previous;
+      }
+
+      memory_scope (const memory_scope&) = delete;
+      memory_scope& operator= (const memory_scope&) = delete;
+
+      /// the resource of the innermost scope of the current thread or nullptr
+      static std::pmr::memory_resource* active () {
+        return current() ? current()->resource : nullptr;
+      }
+
+    private:
+      static memory_scope*& current () {
+        static thread_local memory_scope* scope = nullptr;
+        return scope;
+      }
+
+      std::pmr::memory_resource* resource;
+      memory_scope* previous;
+    };
+
+    /**
+     * scope of reads into existing values.
+     * While a scope exists, the reads of the current thread overwrite the elements of vectors
+     * in place and trim them to the read size, clear maps and sets before reading and reset
+     * struct members missing from the input to their value in a default constructed struct.
+     * The result equals a read into a new value, but vectors and strings keep their capacity
+     * and pointers their pointee. Without a scope, vectors, maps and sets are appended to.
+     */
+    class read_into_scope {
+    public:
+      read_into_scope ()
+        : previous(current())
+      {
+        current() = this;
+      }
+
+      ~read_into_scope () {
+        current() = previous;
+      }
+
+      read_into_scope (const read_into_scope&) = delete;
+      read_into_scope& operator= (const read_into_scope&) = delete;
+
+      /// true if a scope of the current thread exists
+      static bool active () {
+        return current() != nullptr;
+      }
+
+    private:
+      static read_into_scope*& current () {
+        static thread_local read_into_scope* scope = nullptr;
+        return scope;
+      }
+
+      read_into_scope* previous;
+    };
+
+    /// a default constructed T, or nullptr if T is not default constructible
+    template<typename T>
+    inline const T* default_instance () {
+      if constexpr (std::is_default_constructible<T>::value) {
+        static const T t{};
+        return &t;
+      } else {
+        return nullptr;
+      }
+    }
+
+    /// reset the member m of t to its value in a default constructed T
+    template<typename T, typename M>
+    inline void reset_member (T& t, M& m) {
+      if constexpr (std::is_copy_assignable<M>::value) {
+        const char* base = reinterpret_cast<const char*>(&t);
+        const char* member = reinterpret_cast<const char*>(std::addressof(m));
+        const T* d = default_instance<T>();
+        if (d && (member >= base) && (member + sizeof(M) <= base + sizeof(T))) {
+          m = *reinterpret_cast<const M*>(reinterpret_cast<const char*>(d) + (member - base));
+          return;
+        }
+      }
+      if constexpr (std::is_default_constructible<M>::value && std::is_move_assignable<M>::value) {
+        m = M{};
+      }
+    }
+
+    /// reset a property, only plain attributes can be reset
+    template<typename T, typename A>
+    inline void reset_property (T&, A&) {}
+
+    template<typename T, typename M>
+    inline void reset_property (T& t, detail::attribute<M>& a) {
+      reset_member(t, a.value);
+    }
+
+    /// create a shared object, from the resource of the current memory scope if any
+    template<typename T>
+    inline std::shared_ptr<T> make_shared_object () {
+      if (std::pmr::memory_resource* resource = memory_scope::active()) {
+        return std::allocate_shared<T>(std::pmr::polymorphic_allocator<T>(resource));
+      }
+      return std::make_shared<T>();
+    }
+
+    /**
+     * rebuild an empty pmr container or string with the resource of the current memory scope.
+     * The allocator of a pmr container can not be replaced, so the empty object is constructed anew.
+     */
+    template<typename C>
+    inline void adopt_resource (C& c) {
+      if constexpr (uses_pmr<C>::value) {
+        std::pmr::memory_resource* resource = memory_scope::active();
+        if (resource && c.empty() && (c.get_allocator().resource() != resource)) {
+          c.~C();
+          ::new (static_cast<void*>(std::addressof(c))) C(typename C::allocator_type(resource));
+        }
+      }
+    }
+
+    /**
+     * write a tagged value as list of the tag and the value.
+     * The accessor A gives the tag and writes the value.
+     */
+    template<typename Target, typename A>
+    struct write_tagged_t {
+      static void to (Target& out, const A& a) {
+        formatter<Target>::write_list_start(out);
+        formatter<Target>::write_list_element_init(out, 0);
+        write_any(out, a.tag());
+        formatter<Target>::write_list_element_finish(out);
+        formatter<Target>::write_list_element_init(out, 1);
+        a.write(out);
+        formatter<Target>::write_list_element_finish(out);
+        formatter<Target>::write_list_end(out);
+      }
+    };
+
+    template<typename Target, typename A>
+    void write_tagged (Target& out, const A& a) {
+      write_tagged_t<Target, A>::to(out, a);
+    }
+
+    /**
+     * tags of the types derived from a registered base.
+     * The tag of a dynamic type is found by a hash lookup, the types are
+     * created and written through tables indexed by the tag.
+     */
+    template<typename Base, typename List = typename derived_types<Base>::types>
+    struct polymorphic_types;
+
+    template<typename Base, typename ... Types>
+    struct polymorphic_types<Base, type_list<Types...>> {
+      static constexpr std::size_t size = sizeof...(Types);
+
+      /// tag of the dynamic type of b or size if not registered
+      static std::size_t find (const Base& b) {
+        static const std::unordered_map<std::type_index, std::size_t> tags = build(std::index_sequence_for<Types...>());
+        const auto i = tags.find(typeid(b));
+        return i != tags.end() ? i->second : size;
+      }
+
+      /// tag of the dynamic type of b
+      static std::size_t tag (const Base& b) {
+        const std::size_t t = find(b);
+        if (t == size) {
+          throw std::runtime_error(msg_fmt() << "Type '" << typeid(b).name() << "' is not registered for '" << typeid(Base).name() << "'");
+        }
+        return t;
+      }
+
+      static std::shared_ptr<Base> create (std::size_t tag) {
+        typedef std::shared_ptr<Base> (*creator) ();
+        static constexpr creator table[] = { &create_as<Types>... };
+        if (tag >= size) {
+          throw std::runtime_error(msg_fmt() << "Type tag " << tag << " out of range [0, " << size << ") for '" << typeid(Base).name() << "'");
+        }
+        return table[tag]();
+      }
+
+      template<typename Target>
+      static void write (Target& out, std::size_t tag, const Base& b) {
+        typedef void (*writer) (Target&, const Base&);
+        static constexpr writer table[] = { &write_as<Target, Types>... };
+        table[tag](out, b);
+      }
+
+    private:
+      template<std::size_t ... I>
+      static std::unordered_map<std::type_index, std::size_t> build (std::index_sequence<I...>) {
+        return { { std::type_index(typeid(Types)), I }... };
+      }
+
+      template<typename T>
+      static std::shared_ptr<Base> create_as () {
+        return make_shared_object<T>();
+      }
+
+      template<typename Target, typename T>
+      static void write_as (Target& out, const Base& b) {
+        write_any(out, static_cast<const T&>(b));
+      }
+    };
+
+    /// write access to the dynamic type of a registered base
+    template<typename Base>
+    struct polymorphic_writer {
+      explicit polymorphic_writer (const Base& b)
+        : b(b)
+        , t(polymorphic_types<Base>::tag(b))
+      {}
+
+      std::size_t tag () const {
+        return t;
+      }
+
+      template<typename Target>
+      void write (Target& out) const {
+        polymorphic_types<Base>::write(out, t, b);
+      }
+
+      const Base& b;
+      const std::size_t t;
+    };
+
+    /**
+     * write shared values, a registered base with the tag of the dynamic type.
+     * Inside a shared scope the value is tagged by the id of the object.
+     */
     template<typename Target, typename T>
     struct write_shared_t {
       static void to (Target& out, const std::shared_ptr<T>& t) {
-        if (t) {
-          write_any_t<Target, T>::to(out, *t.get());
-        } else {
+        if (!t) {
           formatter<Target>::write_empty_ptr(out);
+        } else if (shared_scope* scope = shared_scope::active()) {
+          write_tagged(out, shared_writer(*scope, *t));
+        } else {
+          value(out, *t);
         }
       }
+
+      static void value (Target& out, const T& t) {
+        if constexpr (is_registered_base<T>::value) {
+          write_tagged(out, polymorphic_writer<T>(t));
+        } else {
+          write_any_t<Target, T>::to(out, t);
+        }
+      }
+
+    private:
+      /// write access to the id of a shared object, only the first occurrence writes the value
+      struct shared_writer {
+        shared_writer (shared_scope& scope, const T& t)
+          : t(t)
+          , id(scope.write_id(&t))
+        {}
+
+        std::size_t tag () const {
+          return id.first;
+        }
+
+        void write (Target& out) const {
+          if (id.second) {
+            value(out, t);
+          } else {
+            formatter<Target>::write_empty_ptr(out);
+          }
+        }
+
+        const T& t;
+        const std::pair<std::size_t, bool> id;
+      };
     };
 
     template<typename Target, typename T>
@@ -263,27 +835,80 @@ namespace persistent {
       write_unique_t<Target, T, D>::to(out, t);
     }
 
+    /// write optional value
+    template<typename Target, typename T>
+    struct write_optional_t {
+      static void to (Target& out, const std::optional<T>& t) {
+        if (t) {
+          write_any(out, *t);
+        } else {
+          formatter<Target>::write_empty_ptr(out);
+        }
+      }
+    };
+
+    template<typename Target, typename T>
+    void write_optional (Target& out, const std::optional<T>& t) {
+      write_optional_t<Target, T>::to(out, t);
+    }
+
+    /// write access to the active alternative of a variant
+    template<typename... Types>
+    struct variant_writer {
+      explicit variant_writer (const std::variant<Types...>& v)
+        : v(v)
+      {}
+
+      std::size_t tag () const {
+        return v.index();
+      }
+
+      template<typename Target>
+      void write (Target& out) const {
+        std::visit([&] (const auto& a) {
+          write_any(out, a);
+        }, v);
+      }
+
+      const std::variant<Types...>& v;
+    };
+
+    /// write variant tagged by the index of the active alternative
+    template<typename Target, typename... Types>
+    struct write_variant_t {
+      static void to (Target& out, const std::variant<Types...>& v) {
+        write_tagged(out, variant_writer<Types...>(v));
+      }
+    };
+
+    template<typename Target, typename... Types>
+    void write_variant (Target& out, const std::variant<Types...>& v) {
+      write_variant_t<Target, Types...>::to(out, v);
+    }
+
     /**
-    * write recursive all elements of a tuple
+    * write all elements of a tuple, named by their index
     */
-    template<std::size_t I, typename Target, typename... Types>
+    template<typename Target, typename... Types>
     struct write_tuple_element_t {
-      static void to (Target& out, std::tuple<const Types...> const& t) {
-        write_tuple_element_t<I - 1, Target, Types...>::to(out, t);
-        formatter<Target>::write_members_delemiter(out);
-        formatter<Target>::write_property_init(out, std::to_string(I));
-        write_any(out, std::get<I>(t));
-        formatter<Target>::write_property_finish(out, std::to_string(I));
+      static void to (Target& out, const std::tuple<Types...>& t) {
+        to(out, t, std::index_sequence_for<Types...>());
       }
-    };
 
-    /// end recursion at 0 elemnt.
-    template<typename Target, typename... Types>
-    struct write_tuple_element_t<0, Target, Types...> {
-      static void to (Target& out, std::tuple<const Types...> const& t) {
-        formatter<Target>::write_property_init(out, "0");
-        write_any(out, std::get<0>(t));
-        formatter<Target>::write_property_finish(out, "0");
+      template<std::size_t ... I>
+      static void to (Target& out, const std::tuple<Types...>& t, std::index_sequence<I...>) {
+        (element<I>(out, std::get<I>(t)), ...);
+      }
+
+      template<std::size_t I, typename T>
+      static void element (Target& out, const T& m) {
+        if constexpr (I > 0) {
+          formatter<Target>::write_members_delemiter(out);
+        }
+        const std::string name = std::to_string(I);
+        formatter<Target>::write_property_init(out, name);
+        write_any(out, m);
+        formatter<Target>::write_property_finish(out, name);
       }
     };
 
@@ -291,7 +916,7 @@ namespace persistent {
     struct write_tuple_t {
       static void to (Target& out, const std::tuple<Types...>& t) {
         formatter<Target>::write_struct_start(out);
-        write_tuple_element_t<(sizeof...(Types)) - 1, Target, Types...>::to(out, t);
+        write_tuple_element_t<Target, Types...>::to(out, t);
         formatter<Target>::write_struct_end(out);
       }
     };
@@ -353,19 +978,40 @@ namespace persistent {
       }
     };
 
+    /// detect strings with other allocators, written as view
+    template<typename Target, typename S>
+    struct write_any_t<Target, S, typename std::enable_if<is_alloc_string<S>::value>::type> {
+      static void to (Target& out, const S& s) {
+        const std::string_view v(s);
+        write_value(out, v);
+      }
+    };
+
     /// detect map
-    template<typename Target, typename K, typename V, typename C, typename A>
-    struct write_any_t<Target, std::map<K, V, C, A>> {
-      static void to (Target& out, const std::map<K, V, C, A>& m) {
+    template<typename Target, typename M>
+    struct write_any_t<Target, M, typename std::enable_if<is_map<M>::value>::type> {
+      static void to (Target& out, const M& m) {
         write_map(out, m);
       }
     };
 
+    /// detect set
+    template<typename Target, typename S>
+    struct write_any_t<Target, S, typename std::enable_if<is_set<S>::value>::type> {
+      static void to (Target& out, const S& s) {
+        write_set(out, s);
+      }
+    };
+
     /// detect struct
     template<typename Target, typename T>
     struct write_any_t<Target, T, typename std::enable_if<is_persistent<T>::value>::type> {
       static void to (Target& out, const T& t) {
-        write_struct(out, persistent::attributes(t));
+        if constexpr (table_driven<Target>::value && field_table<T>::plain) {
+          field_table<T>::get(t).write(out, t);
+        } else {
+          write_struct(out, persistent::attributes(t));
+        }
       }
     };
 
@@ -385,6 +1031,22 @@ namespace persistent {
       }
     };
 
+    /// detect optional
+    template<typename Target, typename T>
+    struct write_any_t<Target, std::optional<T>> {
+      static void to (Target& out, const std::optional<T>& t) {
+        write_optional(out, t);
+      }
+    };
+
+    /// detect variant
+    template<typename Target, typename... Types>
+    struct write_any_t<Target, std::variant<Types...>> {
+      static void to (Target& out, const std::variant<Types...>& v) {
+        write_variant(out, v);
+      }
+    };
+
     /// detect tuple
     template<typename Target, typename... Types>
     struct write_any_t<Target, std::tuple<Types...>> {
@@ -430,6 +1092,102 @@ namespace persistent {
       static void read_struct_element_finish (Source&, const std::string&) {}
 
       static bool is_ptr_empty (Source&) { return true; }
+
+      static void skip_value (Source&) {}
+    };
+
+    /**
+     * number of elements from the current position of the source to the end of
+     * the enclosing list or map. Called at the first element, allows to reserve
+     * the container before reading. May be an estimate, 0 if unknown.
+     */
+    template<typename Source>
+    struct size_hint_t {
+      static std::size_t of (Source&) { return 0; }
+    };
+
+    template<typename Source>
+    inline std::size_t size_hint (Source& in) {
+      return size_hint_t<Source>::of(in);
+    }
+
+    /// reserve space for n elements, if the container supports it
+    template<typename C, typename Enable = void>
+    struct reserve_t {
+      static void to (C&, std::size_t) {}
+    };
+
+    template<typename C>
+    struct reserve_t<C, std::void_t<decltype(std::declval<C&>().reserve(0))>> {
+      static void to (C& c, std::size_t n) {
+        if (n) {
+          c.reserve(n);
+        }
+      }
+    };
+
+    template<typename C>
+    inline void reserve (C& c, std::size_t n) {
+      reserve_t<C>::to(c, n);
+    }
+
+    /// access the value of a key while reading a map
+    template<typename M>
+    struct map_inserter_t {
+      static typename M::mapped_type& element (M& m, const typename M::key_type& k) {
+        return m[k];
+      }
+
+      static void finish (M&) {}
+    };
+
+    /// keys arrive sorted as written by write_map, so each is tried at the end first
+    template<typename K, typename V, typename C, typename A>
+    struct map_inserter_t<std::map<K, V, C, A>> {
+      static V& element (std::map<K, V, C, A>& m, const K& k) {
+        if (!m.empty() && !m.key_comp()(std::prev(m.end())->first, k)) {
+          return m[k];
+        }
+        return m.emplace_hint(m.end(), std::piecewise_construct, std::forward_as_tuple(k), std::forward_as_tuple())->second;
+      }
+
+      static void finish (std::map<K, V, C, A>&) {}
+    };
+
+    /// flat maps are appended while reading and sorted once at the end
+    template<typename K, typename V, typename C, typename A>
+    struct map_inserter_t<flat_map<K, V, C, A>> {
+      static V& element (flat_map<K, V, C, A>& m, const K& k) {
+        m.emplace_back(k, V());
+        return m.back().second;
+      }
+
+      static void finish (flat_map<K, V, C, A>& m) {
+        m.sort();
+      }
+    };
+
+    /// insert the read elements into a set
+    template<typename S>
+    struct set_inserter_t {
+      template<typename V>
+      static void insert (S& s, V& v) {
+        reserve(s, s.size() + v.size());
+        s.insert(std::make_move_iterator(v.begin()), std::make_move_iterator(v.end()));
+      }
+    };
+
+    /// sorted elements are appended to a set without a tree search
+    template<typename K, typename C, typename A>
+    struct set_inserter_t<std::set<K, C, A>> {
+      template<typename V>
+      static void insert (std::set<K, C, A>& s, V& v) {
+        std::sort(v.begin(), v.end(), s.key_comp());
+        auto hint = s.end();
+        for (auto& e : v) {
+          hint = std::next(s.insert(hint, std::move(e)));
+        }
+      }
     };
 
     /// read value
@@ -476,10 +1234,10 @@ namespace persistent {
     };
 
     /// detect setter property
-    template<typename Source, typename T>
-    struct read_property_t<Source, detail::setter<T>> {
-      static inline bool from (Source& in, detail::setter<T>& t) {
-        std::remove_const_t<std::remove_reference_t<T>> v = {};
+    template<typename Source, typename T, typename F>
+    struct read_property_t<Source, detail::setter<T, F>> {
+      static inline bool from (Source& in, detail::setter<T, F>& t) {
+        typename detail::setter<T, F>::type v = {};
         if (read_any(in, v)) {
           set_property_value(t, std::move(v));
           return true;
@@ -493,21 +1251,40 @@ namespace persistent {
       return read_property_t<Source, T>::from(in, t);
     }
 
-    /// read vector
+    /**
+     * read vector, the elements are appended.
+     * In a read_into_scope the existing elements are overwritten in place, elements
+     * behind the read ones are erased and the capacity is kept.
+     */
     template<typename Source, typename T, typename V>
     struct read_vector_t {
       static bool from (Source& in, V& v) {
         if (!parser<Source>::read_list_start(in)) {
           return false;
         }
-        int num = 0;
+        const bool into = read_into_scope::active();
+        const std::size_t first = into ? 0 : v.size();
+        reserve(v, first + size_hint(in));
+        std::size_t i = first;
         bool found = false;
-        while (parser<Source>::read_list_element_init(in, num++)) {
-          T t;
-          found |= read_any(in, t);
-          v.push_back(std::move(t));
+        while (parser<Source>::read_list_element_init(in, static_cast<int>(i - first))) {
+          if (i == v.size()) {
+            v.emplace_back();
+          }
+          if constexpr (std::is_same<typename V::reference, T&>::value) {
+            found |= read_any(in, v[i]);
+          } else {
+            // proxy references, like std::vector<bool>
+            T t = v[i];
+            found |= read_any(in, t);
+            v[i] = std::move(t);
+          }
+          ++i;
           parser<Source>::read_list_element_finish(in);
         }
+        if (into) {
+          v.erase(v.begin() + i, v.end());
+        }
         parser<Source>::read_list_end(in);
         return found;
       }
@@ -542,62 +1319,119 @@ namespace persistent {
       return read_array_t<Source, T, std::array<T, S>>::from(in, t);
     }
 
+    /// read set, the elements are collected and inserted at once
+    template<typename Source, typename S>
+    struct read_set_t {
+      static bool from (Source& in, S& s) {
+        std::vector<typename S::value_type> v;
+        const bool found = read_vector(in, v);
+        if (read_into_scope::active()) {
+          s.clear();
+        }
+        set_inserter_t<S>::insert(s, v);
+        return found;
+      }
+    };
+
+    template<typename Source, typename S>
+    inline bool read_set (Source& in, S& s) {
+      return read_set_t<Source, S>::from(in, s);
+    }
+
     /// read map
-    template<typename Source, typename K, typename V, typename C, typename A>
+    template<typename Source, typename M>
     struct read_map_t {
-      static bool from (Source& in, std::map<K, V, C, A>& m) {
+      static bool from (Source& in, M& m) {
+        typedef typename M::key_type K;
+        typedef typename M::mapped_type V;
         std::string name;
         bool found = false;
+        bool first = true;
+        if (read_into_scope::active()) {
+          m.clear();
+        }
         try {
           while (parser<Source>::read_next_struct_element(in, name)) {
-            found |= read_any<Source, V>(in, m[convert<K>::string_to_key(name)]);
+            if (first) {
+              reserve(m, m.size() + size_hint(in));
+              first = false;
+            }
+            found |= read_any<Source, V>(in, map_inserter_t<M>::element(m, convert<K>::string_to_key(name)));
             parser<Source>::read_struct_element_finish(in, name);
             name.clear();
           }
         } catch (std::exception& ex) {
+          map_inserter_t<M>::finish(m);
           throw std::runtime_error(msg_fmt() << ex.what() << " in map '" << typeid(m).name() << "'");
         }
+        map_inserter_t<M>::finish(m);
         return found;
       }
     };
 
-    template<typename Source, typename K, typename V, typename C, typename A>
-    inline bool read_map (Source& in, std::map<K, V, C, A>& m) {
-      return read_map_t<Source, K, V, C, A>::from(in, m);
+    template<typename Source, typename M>
+    inline bool read_map (Source& in, M& m) {
+      return read_map_t<Source, M>::from(in, m);
     }
 
-    /// read element with name of a tuple
-    template<std::size_t I, typename Source, typename ... Types>
+    /// read element with name of a tuple, the first element with name that reads a value wins
+    /// If seen is set, the flag of the element read is set.
+    template<typename Source, typename ... Types>
     struct read_attributes_t {
-      static bool property (Source& in, const std::string& name, std::tuple<Types...>& t) {
-        bool found = read_attributes_t<I - 1, Source, Types...>::property(in, name, t);
-        if (!found) {
-          auto& f = std::get<I - 1>(t);
-          if (name == get_property_name(f)) {
-            found |= read_property(in, f);
+      static bool property (Source& in, const std::string& name, std::tuple<Types...>& t, bool* seen = nullptr) {
+        return property(in, name, t, seen, std::index_sequence_for<Types...>());
+      }
+
+      template<std::size_t ... I>
+      static bool property (Source& in, const std::string& name, std::tuple<Types...>& t, bool* seen, std::index_sequence<I...>) {
+        return (element(in, name, std::get<I>(t), seen ? seen + I : nullptr) || ...);
+      }
+
+      template<typename T>
+      static bool element (Source& in, const std::string& name, T& f, bool* seen) {
+        if ((name == get_property_name(f)) && read_property(in, f)) {
+          if (seen) {
+            *seen = true;
           }
+          return true;
         }
-        return found;
+        return false;
       }
     };
 
-    /// Stop recoursion at element 0
-    template<typename Source, typename ... Types>
-    struct read_attributes_t<0, Source, Types...> {
-      static inline bool property (Source&, const std::string& name, std::tuple<Types ...>&) {
-        return false;
+    /// check if a tuple has an element with name
+    template<typename ... Types>
+    struct has_attribute_t {
+      static bool is (const std::string& name, const std::tuple<Types...>& t) {
+        return is(name, t, std::index_sequence_for<Types...>());
+      }
+
+      template<std::size_t ... I>
+      static bool is (const std::string& name, const std::tuple<Types...>& t, std::index_sequence<I...>) {
+        return ((name == get_property_name(std::get<I>(t))) || ...);
       }
     };
 
+    /// read the element with name of a tuple, skip the value if no element has this name
+    template<typename Source, typename ... Types>
+    inline bool read_struct_element (Source& in, const std::string& name, std::tuple<Types...>& t, bool* seen = nullptr) {
+      const bool found = read_attributes_t<Source, Types...>::property(in, name, t, seen);
+      if (!found && !has_attribute_t<Types...>::is(name, t)) {
+        // unknown key -> skip the value
+        parser<Source>::skip_value(in);
+      }
+      return found;
+    }
+
     /// read tuple
     template<typename Source, typename ... Types>
     struct read_struct_t {
-      static bool from (Source& in, std::tuple<Types...>& t) {
+      static bool from (Source& in, std::tuple<Types...>& t, bool* seen = nullptr) {
         std::string name;
         bool found = false;
         try {
           while (parser<Source>::read_next_struct_element(in, name)) {
-            found |= read_attributes_t<sizeof...(Types), Source, Types...>::property(in, name, t);
+            found |= read_struct_element(in, name, t, seen);
             parser<Source>::read_struct_element_finish(in, name);
             name.clear();
           }
@@ -609,10 +1443,68 @@ namespace persistent {
     };
 
     template<typename Source, typename ... Types>
-    inline bool read_struct (Source& in, std::tuple<Types...>& t) {
-      return read_struct_t<Source, Types...>::from(in, t);
+    inline bool read_struct (Source& in, std::tuple<Types...>& t, bool* seen = nullptr) {
+      return read_struct_t<Source, Types...>::from(in, t, seen);
     }
 
+    /// read the fields of a struct through its field table, unknown names are skipped
+    template<typename Source, typename T, typename Attributes = decltype(persistent::attributes(std::declval<T&>()))>
+    struct read_fields_t;
+
+    template<typename Source, typename T, typename ... Types>
+    struct read_fields_t<Source, T, std::tuple<Types...>> {
+      static bool from (Source& in, T& t, const field_table<T>& table) {
+        typedef bool (*reader) (Source&, char*);
+        typedef void (*resetter) (T&, char*);
+        static constexpr reader readers[] = { &read_field<typename field_type<Types>::type>... };
+        static constexpr resetter resetters[] = { &reset_field<typename field_type<Types>::type>... };
+        std::string name;
+        bool found = false;
+        std::size_t next = 0;
+        std::array<bool, sizeof...(Types)> seen = {};
+        try {
+          while (parser<Source>::read_next_struct_element(in, name)) {
+            std::size_t i = table.find(name, next);
+            if (i < table.size) {
+              next = i + 1;
+              // of fields with the same name, the first that reads a value wins
+              for (i = table.fields[i].first; i < table.size; i = table.fields[i].next) {
+                if (readers[i](in, table.member(t, i))) {
+                  found = seen[i] = true;
+                  break;
+                }
+              }
+            } else {
+              parser<Source>::skip_value(in);
+            }
+            parser<Source>::read_struct_element_finish(in, name);
+            name.clear();
+          }
+        } catch (std::exception& ex) {
+          throw std::runtime_error(msg_fmt() << ex.what() << " in struct '" << typeid(t).name() << "'");
+        }
+        if (read_into_scope::active()) {
+          for (std::size_t i = 0; i < table.size; ++i) {
+            if (!seen[i]) {
+              resetters[i](t, table.member(t, i));
+            }
+          }
+        }
+        return found;
+      }
+
+    private:
+      template<typename M>
+      static bool read_field (Source& in, char* member) {
+        return read_any(in, *reinterpret_cast<M*>(member));
+      }
+
+      template<typename M>
+      static void reset_field (T& t, char* member) {
+        reset_member(t, *reinterpret_cast<M*>(member));
+      }
+    };
+
     /// read property as attribute
     template<typename Source, typename T>
     struct read_attribute_t {
@@ -661,19 +1553,138 @@ namespace persistent {
       return read_setter_t<Source, T>::from(in, t);
     }
 
-    /// read shared
+    /**
+     * read a tagged value, stored as list of the tag and the value.
+     * The accessor A selects the type of the tag and reads the value of the selected type.
+     */
+    template<typename Source, typename A>
+    struct read_tagged_t {
+      static bool from (Source& in, A& a) {
+        if (!parser<Source>::read_list_start(in)) {
+          return false;
+        }
+        parser<Source>::read_list_element_init(in, 0);
+        std::size_t tag = 0;
+        if (!read_any(in, tag)) {
+          throw std::runtime_error("Could not read type tag");
+        }
+        a.select(tag);
+        parser<Source>::read_list_element_finish(in);
+        parser<Source>::read_list_element_init(in, 1);
+        const bool found = a.read(in);
+        parser<Source>::read_list_element_finish(in);
+        parser<Source>::read_list_end(in);
+        return found;
+      }
+    };
+
+    template<typename Source, typename A>
+    inline bool read_tagged (Source& in, A& a) {
+      return read_tagged_t<Source, A>::from(in, a);
+    }
+
+    /// read access to the dynamic type of a shared pointer to a registered base
+    template<typename Base, typename List = typename derived_types<Base>::types>
+    struct polymorphic_reader;
+
+    template<typename Base, typename ... Types>
+    struct polymorphic_reader<Base, type_list<Types...>> {
+      explicit polymorphic_reader (std::shared_ptr<Base>& p)
+        : p(p)
+      {}
+
+      /// create the type with tag, an existing pointee of this type is kept
+      void select (std::size_t tag) {
+        if (!p || (polymorphic_types<Base>::find(*p) != tag)) {
+          p = polymorphic_types<Base>::create(tag);
+        }
+      }
+
+      /// read the value of the dynamic type
+      template<typename Source>
+      bool read (Source& in) {
+        typedef bool (*reader) (Source&, Base&);
+        static constexpr reader table[] = { &read_as<Source, Types>... };
+        return p && table[polymorphic_types<Base>::tag(*p)](in, *p);
+      }
+
+      std::shared_ptr<Base>& p;
+
+    private:
+      template<typename Source, typename T>
+      static bool read_as (Source& in, Base& b) {
+        return read_any(in, static_cast<T&>(b));
+      }
+    };
+
+    /**
+     * read shared, a registered base by the tag of the dynamic type.
+     * Inside a shared scope the value is tagged by the id of the object.
+     */
     template<typename Source, typename T>
     struct read_shared_t {
       static bool from (Source& in, std::shared_ptr<T>& v) {
         if (parser<Source>::is_ptr_empty(in)) {
           return false;
         }
-        if (!v) {
-          v = std::make_shared<T>();
+        if (shared_scope* scope = shared_scope::active()) {
+          shared_reader a(*scope, v);
+          return read_tagged(in, a);
+        }
+        return value(in, v);
+      }
+
+      static bool value (Source& in, std::shared_ptr<T>& v) {
+        if constexpr (is_registered_base<T>::value) {
+          polymorphic_reader<T> a(v);
+          return read_tagged(in, a);
+        } else {
+          if (!v) {
+            v = make_shared_object<T>();
+          }
+          T& t = *v;
+          return read_any(in, t);
         }
-        T& t = *v;
-        return read_any(in, t);
       }
+
+    private:
+      /// read access to the id of a shared object, an empty value refers to an already read object
+      struct shared_reader {
+        shared_reader (shared_scope& scope, std::shared_ptr<T>& p)
+          : scope(scope)
+          , p(p)
+        {}
+
+        void select (std::size_t tag) {
+          id = tag;
+          selected = true;
+          if (auto s = scope.find(id)) {
+            p = std::static_pointer_cast<T>(s);
+          } else if constexpr (!is_registered_base<T>::value) {
+            // create it here for sources, that read the value in a separate pass
+            if (!p) {
+              p = make_shared_object<T>();
+            }
+            scope.add(id, p);
+          }
+        }
+
+        bool read (Source& in) {
+          if (parser<Source>::is_ptr_empty(in)) {
+            return static_cast<bool>(p);
+          }
+          const bool found = value(in, p);
+          if (selected && p) {
+            scope.add(id, p);
+          }
+          return found;
+        }
+
+        shared_scope& scope;
+        std::shared_ptr<T>& p;
+        std::size_t id = 0;
+        bool selected = false;
+      };
     };
 
     template<typename Source, typename T>
@@ -701,27 +1712,105 @@ namespace persistent {
       return read_unique_t<Source, T, D>::from(in, t);
     }
 
-    /// read element with name of a tuple
-    template<std::size_t I, typename Source, typename ... Types>
-    struct read_tuple_element_t {
-      static bool property (Source& in, const std::string& name, std::tuple<Types...>& t) {
-        bool found = read_tuple_element_t<I - 1, Source, Types...>::property(in, name, t);
-        if (!found) {
-          auto& f = std::get<I - 1>(t);
-          auto n = std::to_string(I - 1);
-          if (name == n) {
-            found |= read_property(in, f);
-          }
+    /// read optional, the value is constructed in place, an empty value resets it
+    template<typename Source, typename T>
+    struct read_optional_t {
+      static bool from (Source& in, std::optional<T>& v) {
+        if (parser<Source>::is_ptr_empty(in)) {
+          v.reset();
+          return true;
         }
-        return found;
+        if (!v) {
+          v.emplace();
+        }
+        return read_any(in, *v);
+      }
+    };
+
+    template<typename Source, typename T>
+    inline bool read_optional (Source& in, std::optional<T>& t) {
+      return read_optional_t<Source, T>::from(in, t);
+    }
+
+    /// read access to the alternatives of a variant through tables build at compile time
+    template<typename ... Types>
+    struct variant_reader {
+      typedef std::variant<Types...> type;
+
+      explicit variant_reader (type& v)
+        : v(v)
+      {}
+
+      /// activate the alternative with tag, an already active one is kept
+      void select (std::size_t tag) {
+        if (tag >= sizeof...(Types)) {
+          throw std::runtime_error(msg_fmt() << "Variant index " << tag << " out of range [0, " << sizeof...(Types) << ")");
+        }
+        if (v.index() != tag) {
+          selectors(std::index_sequence_for<Types...>())[tag](v);
+        }
+      }
+
+      /// read the value of the active alternative
+      template<typename Source>
+      bool read (Source& in) {
+        return readers<Source>(std::index_sequence_for<Types...>())[v.index()](in, v);
+      }
+
+      type& v;
+
+    private:
+      typedef void (*selector) (type&);
+
+      // tables by index, so alternatives of the same type are distinct
+      template<std::size_t ... I>
+      static const selector* selectors (std::index_sequence<I...>) {
+        static constexpr selector table[] = { &emplace<I>... };
+        return table;
+      }
+
+      template<std::size_t I>
+      static void emplace (type& v) {
+        v.template emplace<I>();
+      }
+
+      template<typename Source, std::size_t ... I>
+      static auto readers (std::index_sequence<I...>) {
+        typedef bool (*reader) (Source&, type&);
+        static constexpr reader table[] = { &read_alternative<Source, I>... };
+        return table;
+      }
+
+      template<typename Source, std::size_t I>
+      static bool read_alternative (Source& in, type& v) {
+        return read_any(in, *std::get_if<I>(&v));
       }
     };
 
-    /// Stop recoursion at element 0
+    /// read variant tagged by the index of the alternative
     template<typename Source, typename ... Types>
-    struct read_tuple_element_t<0, Source, Types...> {
-      static inline bool property (Source&, const std::string& name, std::tuple<Types ...>&) {
-        return false;
+    struct read_variant_t {
+      static bool from (Source& in, std::variant<Types...>& v) {
+        variant_reader<Types...> a(v);
+        return read_tagged(in, a);
+      }
+    };
+
+    template<typename Source, typename ... Types>
+    inline bool read_variant (Source& in, std::variant<Types...>& v) {
+      return read_variant_t<Source, Types...>::from(in, v);
+    }
+
+    /// read element of a tuple named by its index
+    template<typename Source, typename ... Types>
+    struct read_tuple_element_t {
+      static bool property (Source& in, const std::string& name, std::tuple<Types...>& t) {
+        return property(in, name, t, std::index_sequence_for<Types...>());
+      }
+
+      template<std::size_t ... I>
+      static bool property (Source& in, const std::string& name, std::tuple<Types...>& t, std::index_sequence<I...>) {
+        return (((name == std::to_string(I)) && read_property(in, std::get<I>(t))) || ...);
       }
     };
 
@@ -732,12 +1821,26 @@ namespace persistent {
         std::string name;
         bool found = false;
         while (parser<Source>::read_next_struct_element(in, name)) {
-          found |= read_tuple_element_t<sizeof...(Types), Source, Types...>::property(in, name, t);
+          const bool read = read_tuple_element_t<Source, Types...>::property(in, name, t);
+          if (!read && !is_element_index(name)) {
+            // unknown index -> skip the value
+            parser<Source>::skip_value(in);
+          }
+          found |= read;
           parser<Source>::read_struct_element_finish(in, name);
           name.clear();
         }
         return found;
       }
+
+      static bool is_element_index (const std::string& name) {
+        for (std::size_t i = 0; i < sizeof...(Types); ++i) {
+          if (name == std::to_string(i)) {
+            return true;
+          }
+        }
+        return false;
+      }
     };
 
     template<typename Source, typename ... Types>
@@ -781,9 +1884,9 @@ namespace persistent {
     };
 
     /// detect setter
-    template<typename Source, typename T>
-    struct read_any_t<Source, detail::setter<T>> {
-      static inline bool from (Source& in, detail::setter<T>& t) {
+    template<typename Source, typename T, typename F>
+    struct read_any_t<Source, detail::setter<T, F>> {
+      static inline bool from (Source& in, detail::setter<T, F>& t) {
         return read_setter(in, t);
       }
     };
@@ -792,6 +1895,7 @@ namespace persistent {
     template<typename Source, typename T, typename A>
     struct read_any_t<Source, std::vector<T, A>> {
       static inline bool from (Source& in, std::vector<T, A>& t) {
+        adopt_resource(t);
         return read_vector(in, t);
       }
     };
@@ -805,19 +1909,59 @@ namespace persistent {
     };
 
     /// detect map
-    template<typename Source, typename K, typename V, typename C, typename A>
-    struct read_any_t<Source, std::map<K, V, C, A>> {
-      static inline bool from (Source& in, std::map<K, V, C, A>& m) {
+    template<typename Source, typename M>
+    struct read_any_t<Source, M, typename std::enable_if<is_map<M>::value>::type> {
+      static inline bool from (Source& in, M& m) {
+        adopt_resource(m);
         return read_map(in, m);
       }
     };
 
+    /// detect set
+    template<typename Source, typename S>
+    struct read_any_t<Source, S, typename std::enable_if<is_set<S>::value>::type> {
+      static inline bool from (Source& in, S& s) {
+        adopt_resource(s);
+        return read_set(in, s);
+      }
+    };
+
+    /// detect strings with other allocators, read through a reused std::string
+    template<typename Source, typename S>
+    struct read_any_t<Source, S, typename std::enable_if<is_alloc_string<S>::value>::type> {
+      static inline bool from (Source& in, S& s) {
+        static thread_local std::string buffer;
+        buffer.clear();
+        if (!read_any(in, buffer)) {
+          return false;
+        }
+        adopt_resource(s);
+        s.assign(buffer.data(), buffer.size());
+        return true;
+      }
+    };
+
     /// detect struct
     template<typename Source, typename T>
     struct read_any_t<Source, T, typename std::enable_if<is_persistent<T>::value>::type> {
       static inline bool from (Source& in, T& t) {
-        auto attr = persistent::attributes(t);
-        return read_struct(in, attr);
+        if constexpr (table_driven<Source>::value && field_table<T>::plain) {
+          return read_fields_t<Source, T>::from(in, t, field_table<T>::get(t));
+        } else {
+          auto attr = persistent::attributes(t);
+          if (!read_into_scope::active()) {
+            return read_struct(in, attr);
+          }
+          std::array<bool, std::tuple_size<decltype(attr)>::value> seen = {};
+          const bool found = read_struct(in, attr, seen.data());
+          reset_missing(t, attr, seen, std::make_index_sequence<std::tuple_size<decltype(attr)>::value>());
+          return found;
+        }
+      }
+
+      template<typename A, std::size_t ... I>
+      static void reset_missing (T& t, A& attr, const std::array<bool, sizeof...(I)>& seen, std::index_sequence<I...>) {
+        ((seen[I] || (reset_property(t, std::get<I>(attr)), true)), ...);
       }
     };
 
@@ -837,6 +1981,22 @@ namespace persistent {
       }
     };
 
+    /// detect optional
+    template<typename Source, typename T>
+    struct read_any_t<Source, std::optional<T>> {
+      static inline bool from (Source& in, std::optional<T>& t) {
+        return read_optional(in, t);
+      }
+    };
+
+    /// detect variant
+    template<typename Source, typename... Types>
+    struct read_any_t<Source, std::variant<Types...>> {
+      static inline bool from (Source& in, std::variant<Types...>& v) {
+        return read_variant(in, v);
+      }
+    };
+
     /// detect tuple
     template<typename Source, typename... Types>
     struct read_any_t<Source, std::tuple<Types...>> {
@@ -22,6 +22,19 @@
 //
 #include <iostream>
 #include <iomanip>
+#include <charconv>
+#include <cstdint>
+#include <string_view>
+#include <memory_resource>
+#ifdef _WIN32
+# include <fstream>
+# include <iterator>
+#else
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+#endif
 
 // --------------------------------------------------------------------------
 //
@@ -38,6 +51,9 @@ namespace persistent {
     //
     // specializations for ostream
     //
+    template<>
+    struct table_driven<std::ostream> : std::true_type {};
+
     template<>
     struct formatter<std::ostream> {
 
@@ -88,6 +104,13 @@ namespace persistent {
       }
     };
 
+    template<>
+    struct write_value_t<std::ostream, const std::string_view> {
+      static void to (std::ostream& os, const std::string_view& t) {
+        os << std::quoted(t);
+      }
+    };
+
     template<>
     struct write_value_t<std::ostream, const char*> {
       static void to (std::ostream& os, const char* t) {
@@ -177,6 +200,9 @@ namespace persistent {
 
     };
 
+    template<>
+    struct table_driven<ios_formatter_context> : std::true_type {};
+
     template<>
     struct formatter<ios_formatter_context> {
 
@@ -237,10 +263,217 @@ namespace persistent {
       write(out, t);
     }
 
+    // --------------------------------------------------------------------------
+    //
+    // istream to read from contiguous memory without to copy it
+    //
+    struct memory_buffer : public std::streambuf {
+      memory_buffer (const char* begin, const char* end) {
+        char* b = const_cast<char*>(begin);
+        setg(b, b, const_cast<char*>(end));
+      }
+    };
+
+    struct imemstream : private memory_buffer, public std::istream {
+      imemstream (const char* begin, const char* end)
+        : memory_buffer(begin, end)
+        , std::istream(static_cast<std::streambuf*>(this))
+      {}
+
+      imemstream (const char* data, std::size_t size)
+        : imemstream(data, data + size)
+      {}
+
+      /// read from an other memory range and clear the stream state.
+      void reset (const char* begin, const char* end) {
+        char* b = const_cast<char*>(begin);
+        setg(b, b, const_cast<char*>(end));
+        clear();
+      }
+    };
+
+    // --------------------------------------------------------------------------
+    //
+    // scratch memory of a borrowed read. std::string_view members read from
+    // contiguous memory point into the input, text that has to be decoded is
+    // copied here. The views are valid as long as the input and the arena.
+    //
+    class scratch_arena {
+    public:
+      explicit scratch_arena (std::size_t initial_size = 1024)
+        : arena(initial_size)
+      {}
+
+      scratch_arena (const scratch_arena&) = delete;
+      scratch_arena& operator= (const scratch_arena&) = delete;
+
+      char* allocate (std::size_t size) {
+        return static_cast<char*>(arena.allocate(size ? size : 1, 1));
+      }
+
+      /// release all decoded text, the views into the arena become invalid.
+      void clear () {
+        arena.release();
+      }
+
+    private:
+      std::pmr::monotonic_buffer_resource arena;
+    };
+
+    /// encode a code point as utf-8.
+    inline char* write_utf8 (std::uint32_t cp, char* out) {
+      if (cp < 0x80) {
+        *out++ = static_cast<char>(cp);
+      } else if (cp < 0x800) {
+        *out++ = static_cast<char>(0xC0 | (cp >> 6));
+        *out++ = static_cast<char>(0x80 | (cp & 0x3F));
+      } else if (cp < 0x10000) {
+        *out++ = static_cast<char>(0xE0 | (cp >> 12));
+        *out++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        *out++ = static_cast<char>(0x80 | (cp & 0x3F));
+      } else if (cp < 0x110000) {
+        *out++ = static_cast<char>(0xF0 | (cp >> 18));
+        *out++ = static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        *out++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        *out++ = static_cast<char>(0x80 | (cp & 0x3F));
+      } else {
+        throw std::runtime_error(msg_fmt() << "Invalid character reference " << cp);
+      }
+      return out;
+    }
+
+    // --------------------------------------------------------------------------
+    //
+    // read only memory mapped file, read to memory on systems without mmap
+    //
+    struct mapped_file {
+      explicit mapped_file (const std::string& filename) {
+#ifdef _WIN32
+        std::ifstream f(filename, std::ios::binary);
+        if (!f) {
+          throw std::runtime_error(msg_fmt() << "Could not open file '" << filename << "'");
+        }
+        content.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+        ptr = content.data();
+        len = content.size();
+#else
+        const int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+          throw std::runtime_error(msg_fmt() << "Could not open file '" << filename << "'");
+        }
+        struct stat st = {};
+        if ((::fstat(fd, &st) == 0) && (st.st_size > 0)) {
+          void* p = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+          if (p != MAP_FAILED) {
+            ptr = static_cast<const char*>(p);
+            len = st.st_size;
+          }
+        }
+        ::close(fd);
+        if (!ptr && (st.st_size > 0)) {
+          throw std::runtime_error(msg_fmt() << "Could not map file '" << filename << "'");
+        }
+#endif
+      }
+
+      ~mapped_file () {
+#ifndef _WIN32
+        if (ptr) {
+          ::munmap(const_cast<char*>(ptr), len);
+        }
+#endif
+      }
+
+      mapped_file (const mapped_file&) = delete;
+      mapped_file& operator= (const mapped_file&) = delete;
+
+      const char* data () const {
+        return ptr;
+      }
+
+      std::size_t size () const {
+        return len;
+      }
+
+    private:
+#ifdef _WIN32
+      std::string content;
+#endif
+      const char* ptr = nullptr;
+      std::size_t len = 0;
+    };
+
+    // --------------------------------------------------------------------------
+    //
+    // access to the already buffered input of a streambuf.
+    // The protected members are reached by a member pointer of the derived class.
+    //
+    struct streambuf_access : public std::streambuf {
+      static const char* begin (std::streambuf* buf) {
+        return (buf->*&streambuf_access::gptr)();
+      }
+
+      static const char* end (std::streambuf* buf) {
+        return (buf->*&streambuf_access::egptr)();
+      }
+
+      static void bump (std::streambuf* buf, int n) {
+        (buf->*&streambuf_access::gbump)(n);
+      }
+    };
+
+    /**
+     * count the elements from first to the end of the enclosing list or struct.
+     * If the end is not in the range, the elements found so far are returned.
+     */
+    inline std::size_t count_elements (const char* first, const char* last) {
+      while ((first < last) && ::isspace(static_cast<unsigned char>(*first))) {
+        ++first;
+      }
+      if ((first == last) || (*first == ']') || (*first == '}')) {
+        return 0;
+      }
+      std::size_t count = 1;
+      int depth = 0;
+      for (; first < last; ++first) {
+        switch (*first) {
+          case '"':
+          case '\'': {
+            const char quote = *first;
+            for (++first; (first < last) && (*first != quote); ++first) {
+              if (*first == '\\') {
+                ++first;
+              }
+            }
+            break;
+          }
+          case '[':
+          case '{':
+            ++depth;
+            break;
+          case ']':
+          case '}':
+            if (depth-- == 0) {
+              return count;
+            }
+            break;
+          case ',':
+            if (depth == 0) {
+              ++count;
+            }
+            break;
+        }
+      }
+      return count;
+    }
+
     // --------------------------------------------------------------------------
     //
     // specializations for istream
     //
+    template<>
+    struct table_driven<std::istream> : std::true_type {};
+
     template<>
     struct parser<std::istream> {
       static inline bool read_list_start (std::istream& is) {
@@ -321,6 +554,72 @@ namespace persistent {
         return (delim == ']') || (delim == '}') || (delim == ',');
       }
 
+      /// skip the next value including nested lists and structs without to allocate memory.
+      static void skip_value (std::istream& is) {
+        typedef std::char_traits<char> traits;
+        std::streambuf* buf = (is >> std::ws).rdbuf();
+        int depth = 0;
+        for (auto c = buf->sgetc(); !traits::eq_int_type(c, traits::eof()); c = buf->sgetc()) {
+          switch (c) {
+            case '"':
+            case '\'':
+              skip_quoted(buf, c);
+              if (depth == 0) {
+                return;
+              }
+              continue;
+            case '[':
+            case '{':
+              ++depth;
+              break;
+            case ']':
+            case '}':
+              if (depth == 0) {
+                return;
+              }
+              if (--depth == 0) {
+                buf->sbumpc();
+                return;
+              }
+              break;
+            case ',':
+              if (depth == 0) {
+                return;
+              }
+              break;
+            default:
+              if ((depth == 0) && ::isspace(c)) {
+                return;
+              }
+              break;
+          }
+          buf->sbumpc();
+        }
+        is.setstate(std::ios_base::eofbit);
+      }
+
+      /// skip a quoted string, including the quotes and escaped characters.
+      static void skip_quoted (std::streambuf* buf, const int quote) {
+        typedef std::char_traits<char> traits;
+        buf->sbumpc();
+        for (auto c = buf->sbumpc(); !traits::eq_int_type(c, traits::eof()); c = buf->sbumpc()) {
+          if (c == '\\') {
+            buf->sbumpc();
+          } else if (c == quote) {
+            return;
+          }
+        }
+      }
+
+    };
+
+    /// count the elements in the buffered input
+    template<>
+    struct size_hint_t<std::istream> {
+      static std::size_t of (std::istream& is) {
+        std::streambuf* buf = is.rdbuf();
+        return buf ? count_elements(streambuf_access::begin(buf), streambuf_access::end(buf)) : 0;
+      }
     };
 
     template<typename T>
@@ -329,9 +628,29 @@ namespace persistent {
         if (parser<std::istream>::is_next_delimiter(is)) {
           return false;
         }
+        if constexpr (is_number<T>::value) {
+          if (from_buffer(is.rdbuf(), t)) {
+            return true;
+          }
+        }
         is >> t;
         return true;
       }
+
+      /// parse a number completely inside the buffered input without a locale and without to allocate
+      static bool from_buffer (std::streambuf* buf, T& t) {
+        const char* first = buf ? streambuf_access::begin(buf) : nullptr;
+        const char* last = buf ? streambuf_access::end(buf) : nullptr;
+        if (first == last) {
+          return false;
+        }
+        const auto r = std::from_chars(first, last, t);
+        if ((r.ec != std::errc()) || (r.ptr == last)) {
+          return false;
+        }
+        streambuf_access::bump(buf, static_cast<int>(r.ptr - first));
+        return true;
+      }
     };
 
     template<>
@@ -346,6 +665,14 @@ namespace persistent {
       }
     };
 
+    /// a view needs a borrowed read from contiguous memory
+    template<>
+    struct read_value_t<std::istream, std::string_view> {
+      static bool from (std::istream&, std::string_view&) {
+        throw std::runtime_error("std::string_view can only be read borrowed from contiguous memory");
+      }
+    };
+
     template<>
     struct read_value_t<std::istream, char> {
       static bool from (std::istream& is, char& c) {
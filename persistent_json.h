@@ -16,6 +16,12 @@
 
 #pragma once
 
+// --------------------------------------------------------------------------
+//
+// Common includes
+//
+#include <algorithm>
+
 // --------------------------------------------------------------------------
 //
 // Project includes
@@ -27,6 +33,117 @@ namespace persistent {
 
   namespace io {
 
+    namespace json {
+
+      /// write t as quoted string, quotes, backslashes and control characters are escaped.
+      inline void write_string (std::ostream& os, std::string_view t) {
+        static const char hex[] = "0123456789abcdef";
+        os.put('"');
+        const char* first = t.data();
+        const char* const last = first + t.size();
+        for (const char* p = first; p != last; ++p) {
+          const unsigned char c = static_cast<unsigned char>(*p);
+          if ((c >= 0x20) && (c != '"') && (c != '\\')) {
+            continue;
+          }
+          os.write(first, p - first);
+          first = p + 1;
+          switch (c) {
+            case '"': os.write("\\\"", 2); break;
+            case '\\': os.write("\\\\", 2); break;
+            case '\b': os.write("\\b", 2); break;
+            case '\f': os.write("\\f", 2); break;
+            case '\n': os.write("\\n", 2); break;
+            case '\r': os.write("\\r", 2); break;
+            case '\t': os.write("\\t", 2); break;
+            default: {
+              const char u[] = { '\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF] };
+              os.write(u, sizeof(u));
+            }
+          }
+        }
+        os.write(first, last - first);
+        os.put('"');
+      }
+
+      inline std::uint32_t code_unit (const char*& first, const char* last) {
+        std::uint32_t u = 0;
+        const char* end = (last - first >= 4) ? first + 4 : last;
+        const auto r = std::from_chars(first, end, u, 16);
+        if ((r.ec != std::errc()) || (r.ptr != first + 4)) {
+          throw std::runtime_error(msg_fmt() << "Invalid unicode escape '\\u" << std::string_view(first, end - first) << "'");
+        }
+        first += 4;
+        return u;
+      }
+
+      /**
+       * decode the escapes of the string between first and last to out, returns the end of
+       * the decoded string. The decoded string is never longer, so out may be first.
+       */
+      inline char* unescape (const char* first, const char* last, char* out) {
+        while (first != last) {
+          char c = *first++;
+          if ((c == '\\') && (first != last)) {
+            c = *first++;
+            switch (c) {
+              case 'b': c = '\b'; break;
+              case 'f': c = '\f'; break;
+              case 'n': c = '\n'; break;
+              case 'r': c = '\r'; break;
+              case 't': c = '\t'; break;
+              case 'u': {
+                std::uint32_t cp = code_unit(first, last);
+                if ((cp >= 0xDC00) && (cp < 0xE000)) {
+                  throw std::runtime_error(msg_fmt() << "Unpaired low surrogate '\\u" << std::hex << cp << "'");
+                }
+                if ((cp >= 0xD800) && (cp < 0xDC00)) {
+                  const char* low = first + 2;
+                  const std::uint32_t next = ((last - first >= 6) && (first[0] == '\\') && (first[1] == 'u')) ? code_unit(low, last) : 0;
+                  if ((next < 0xDC00) || (next >= 0xE000)) {
+                    throw std::runtime_error(msg_fmt() << "Unpaired high surrogate '\\u" << std::hex << cp << "'");
+                  }
+                  first = low;
+                  cp = 0x10000 + ((cp - 0xD800) << 10) + (next - 0xDC00);
+                }
+                out = write_utf8(cp, out);
+                continue;
+              }
+            }
+          }
+          *out++ = c;
+        }
+        return out;
+      }
+
+      /// read a string quoted by '"' or '\'' and decode its escapes, false if the next character is no quote.
+      inline bool read_string (std::istream& is, std::string& t) {
+        const int delim = is.peek();
+        if ((delim != '"') && (delim != '\'')) {
+          return false;
+        }
+        is.ignore();
+        if (!std::getline(is, t, static_cast<char>(delim))) {
+          return false;
+        }
+        // the quote was escaped if an odd number of backslashes precedes it
+        auto escaped = [&] () {
+          const auto last = t.find_last_not_of('\\');
+          return ((t.size() - (last == std::string::npos ? 0 : last + 1)) % 2) == 1;
+        };
+        std::string rest;
+        while (escaped() && std::getline(is, rest, static_cast<char>(delim))) {
+          t.push_back(static_cast<char>(delim));
+          t.append(rest);
+        }
+        if (t.find('\\') != std::string::npos) {
+          t.resize(unescape(t.data(), t.data() + t.size(), t.data()) - t.data());
+        }
+        return is.good();
+      }
+
+    } // namespace json
+
     // --------------------------------------------------------------------------
     //
     // specializations for json formatted ostream
@@ -37,11 +154,15 @@ namespace persistent {
       {}
     };
 
+    template<>
+    struct table_driven<json_formatter_context> : std::true_type {};
+
     template<>
     struct formatter<json_formatter_context> : public formatter<ios_formatter_context> {
 
       static void write_property_init (json_formatter_context& out, const std::string& key) {
-        out.os << std::quoted(key) << (out.beautify ? ": " : ":");
+        json::write_string(out.os, key);
+        out.os << (out.beautify ? ": " : ":");
       }
 
       static void write_empty_ptr (json_formatter_context& out) {
@@ -50,6 +171,25 @@ namespace persistent {
 
     };
 
+    template<>
+    struct key_fragments<json_formatter_context> {
+      static constexpr bool rendered = true;
+
+      static key_fragment render (const std::string& key, bool beautify) {
+        std::ostringstream os;
+        json::write_string(os, key);
+        os << (beautify ? ": " : ":");
+        return { os.str(), {} };
+      }
+
+      static void write_property_init (json_formatter_context& out, const key_fragment& key) {
+        out.os.write(key.init.data(), key.init.size());
+      }
+
+      static void write_property_finish (json_formatter_context&, const key_fragment&) {
+      }
+    };
+
     template<typename T>
     struct write_value_t<json_formatter_context, T> {
       static void to (json_formatter_context& out, const T& t) {
@@ -60,21 +200,28 @@ namespace persistent {
     template<>
     struct write_value_t<json_formatter_context, const std::string> {
       static void to (json_formatter_context& out, const std::string& t) {
-        out.os << '"' << t << '"';
+        json::write_string(out.os, t);
+      }
+    };
+
+    template<>
+    struct write_value_t<json_formatter_context, const std::string_view> {
+      static void to (json_formatter_context& out, const std::string_view& t) {
+        json::write_string(out.os, t);
       }
     };
 
     template<>
     struct write_value_t<json_formatter_context, const char*> {
       static void to (json_formatter_context& out, const char*& t) {
-        out.os << '"' << t << '"';
+        json::write_string(out.os, t);
       }
     };
 
     template<std::size_t T>
     struct write_value_t<json_formatter_context, const char[T]> {
       static void to (json_formatter_context& out, const char(&t)[T]) {
-        out.os << '"' << t << '"';
+        json::write_string(out.os, t);
       }
     };
 
@@ -89,13 +236,18 @@ namespace persistent {
     // specializations for json formatted istream
     //
     struct json_parser_context {
-      json_parser_context (std::istream& is)
+      json_parser_context (std::istream& is, scratch_arena* scratch = nullptr)
         : is(is)
+        , scratch(scratch)
       {}
 
       std::istream& is;
+      scratch_arena* scratch;  /// borrowed read of std::string_view members if set
     };
 
+    template<>
+    struct table_driven<json_parser_context> : std::true_type {};
+
     template<>
     struct parser<json_parser_context> {
       static bool read_list_start (json_parser_context& in) {
@@ -115,7 +267,9 @@ namespace persistent {
       }
 
       static void read_property_init (json_parser_context& in, std::string& key) {
-        in.is >> std::ws >> std::quoted(key);
+        if (!json::read_string(in.is >> std::ws, key)) {
+          in.is >> std::quoted(key);
+        }
         parser<std::istream>::read_char(in.is, ':');
       }
 
@@ -153,6 +307,17 @@ namespace persistent {
         return true;
       }
 
+      static void skip_value (json_parser_context& in) {
+        parser<std::istream>::skip_value(in.is);
+      }
+
+    };
+
+    template<>
+    struct size_hint_t<json_parser_context> {
+      static std::size_t of (json_parser_context& in) {
+        return size_hint(in.is);
+      }
     };
 
     template<typename T>
@@ -167,12 +332,49 @@ namespace persistent {
     struct read_value_t<json_parser_context, std::string> {
       static bool from (json_parser_context& in, std::string& t) {
         in.is >> std::ws;
-        if ((in.is.peek() != '"') && (in.is.peek() != '\'')) {
+        return json::read_string(in.is, t);
+      }
+    };
+
+    /**
+     * borrowed read of a string as view into the contiguous input.
+     * Only strings with escapes are decoded, into the scratch arena.
+     */
+    template<>
+    struct read_value_t<json_parser_context, std::string_view> {
+      static bool from (json_parser_context& in, std::string_view& t) {
+        if (!in.scratch) {
+          return read_value(in.is, t);
+        }
+        in.is >> std::ws;
+        const int delim = in.is.peek();
+        if ((delim != '"') && (delim != '\'')) {
           return false;
         }
-        char delim;
-        in.is >> delim;
-        return std::getline(in.is, t, delim).good();
+        std::streambuf* buf = in.is.rdbuf();
+        const char* begin = streambuf_access::begin(buf);
+        const char* first = begin + 1;
+        const char* last = streambuf_access::end(buf);
+        const char* end = first;
+        bool escaped = false;
+        while ((end < last) && (*end != delim)) {
+          if (*end == '\\') {
+            escaped = true;
+            ++end;
+          }
+          ++end;
+        }
+        if (end >= last) {
+          throw std::runtime_error("Unterminated string");
+        }
+        if (escaped) {
+          char* data = in.scratch->allocate(end - first);
+          t = std::string_view(data, json::unescape(first, end, data) - data);
+        } else {
+          t = std::string_view(first, end - first);
+        }
+        streambuf_access::bump(buf, static_cast<int>(end + 1 - begin));
+        return true;
       }
     };
 
@@ -182,6 +384,141 @@ namespace persistent {
       return read(f, t);
     }
 
+    /// read with the strings, containers and pointees created by the read allocated from resource.
+    template<typename T>
+    inline bool read_json (std::istream& is, T& t, std::pmr::memory_resource* resource) {
+      memory_scope scope(resource);
+      return read_json(is, t);
+    }
+
+    /// borrowed read, std::string_view members point into data or into the scratch arena.
+    template<typename T>
+    inline bool read_json (std::string_view data, T& t, scratch_arena& scratch) {
+      imemstream is(data.data(), data.size());
+      json_parser_context f(is, &scratch);
+      return read(f, t);
+    }
+
+    // --------------------------------------------------------------------------
+    //
+    // resumable json reader for incrementally arriving input.
+    // The chunks are scanned once to track nesting and strings, each completed
+    // top level member of a persistent struct is read as soon as it's complete.
+    // Other types are read when the whole document has arrived.
+    //
+    template<typename T>
+    struct json_push_parser {
+
+      explicit json_push_parser (T& target)
+        : target(target)
+      {}
+
+      /// add the next chunk, returns true if the document is complete.
+      bool feed (const char* data, std::size_t size) {
+        if (size) {
+          buffer.append(data, size);
+        }
+        for (; !done && (pos < buffer.size()); ++pos) {
+          const char c = buffer[pos];
+          if (quote) {
+            if (escape) {
+              escape = false;
+            } else if (c == '\\') {
+              escape = true;
+            } else if (c == quote) {
+              quote = 0;
+            }
+            continue;
+          }
+          switch (c) {
+            case '"':
+            case '\'':
+              quote = c;
+              break;
+            case '[':
+            case '{':
+              if (depth++ == 0) {
+                begin = pos + 1;
+              }
+              break;
+            case ']':
+            case '}':
+              if (depth == 0) {
+                throw std::runtime_error(msg_fmt() << "Unexpected '" << c << "' at top level");
+              }
+              if (--depth == 0) {
+                read_member(pos);
+                done = true;
+              }
+              break;
+            case ',':
+              if (depth == 1) {
+                read_member(pos);
+              }
+              break;
+            default:
+              if ((depth == 0) && !::isspace(static_cast<unsigned char>(c))) {
+                throw std::runtime_error(msg_fmt() << "Expected '{' or '[' but got '" << c << "'");
+              }
+              break;
+          }
+        }
+        if constexpr (!is_persistent<T>::value) {
+          if (done) {
+            imemstream is(buffer.data(), pos);
+            read_json(is, target);
+          }
+        } else if (begin > 0) {
+          // drop the already read members
+          buffer.erase(0, begin);
+          pos -= begin;
+          begin = 0;
+        }
+        return done;
+      }
+
+      /// true if the document is complete.
+      bool complete () const {
+        return done;
+      }
+
+      /// prepare to read the next document from the data following the current one.
+      void reset () {
+        buffer.erase(0, pos);
+        pos = begin = 0;
+        depth = 0;
+        quote = 0;
+        escape = done = false;
+      }
+
+    private:
+      void read_member (std::size_t end) {
+        if constexpr (is_persistent<T>::value) {
+          const char* first = buffer.data() + begin;
+          const char* last = buffer.data() + end;
+          begin = end + 1;
+          if (std::all_of(first, last, [] (char c) { return ::isspace(static_cast<unsigned char>(c)); })) {
+            return;
+          }
+          imemstream is(first, last);
+          json_parser_context in(is);
+          parser<json_parser_context>::read_property_init(in, name);
+          auto attr = persistent::attributes(target);
+          read_struct_element(in, name, attr);
+        }
+      }
+
+      T& target;
+      std::string buffer;
+      std::string name;
+      std::size_t pos = 0;
+      std::size_t begin = 0;
+      int depth = 0;
+      char quote = 0;
+      bool escape = false;
+      bool done = false;
+    };
+
 
   } // namespace io
 
@@ -35,6 +35,11 @@ namespace persistent {
 
     typedef boost::property_tree::ptree ptree;
 
+    /// append an empty child and return it to be written in place.
+    inline ptree& add_child (ptree& p, const std::string& name) {
+      return p.push_back(ptree::value_type(name, ptree()))->second;
+    }
+
     // --------------------------------------------------------------------------
     //
     // write
@@ -52,10 +57,8 @@ namespace persistent {
     /// write property
     template<typename T>
     struct write_attribute_t<ptree, T> {
-      static void to (ptree& p, const attribute<T>& t) {
-        ptree child;
-        write_any(child, get_property_value(t));
-        p.add_child(get_property_name(t), child);
+      static void to (ptree& p, const T& t) {
+        write_any(add_child(p, get_property_name(t)), get_property_value(t));
       }
     };
 
@@ -64,9 +67,7 @@ namespace persistent {
     struct writeList_t<ptree, T, V> {
       static void to (ptree& p, const V& v) {
         for (const T& t : v) {
-          ptree pt;
-          write_any(pt, t);
-          p.push_back(std::make_pair("", pt));
+          write_any(add_child(p, {}), t);
         }
       }
     };
@@ -75,12 +76,27 @@ namespace persistent {
     template<typename T1, typename T2>
     struct write_pair_t<ptree, T1, T2> {
       static void to (ptree& p, const std::pair<T1, T2>& v) {
-        ptree pt;
-        write_any(pt, v.first);
-        p.push_back(std::make_pair("", pt));
-        pt.clear();
-        write_any(pt, v.second);
-        p.push_back(std::make_pair("", pt));
+        write_any(add_child(p, {}), v.first);
+        write_any(add_child(p, {}), v.second);
+      }
+    };
+
+    /// write tagged value as tag and value
+    template<typename A>
+    struct write_tagged_t<ptree, A> {
+      static void to (ptree& p, const A& a) {
+        write_any(add_child(p, {}), a.tag());
+        a.write(add_child(p, {}));
+      }
+    };
+
+    /// write map
+    template<typename M>
+    struct write_map_t<ptree, M> {
+      static void to (ptree& p, const M& m) {
+        for (const auto& e : m) {
+          write_any(add_child(p, convert<typename M::key_type>::key_to_string(e.first)), e.second);
+        }
       }
     };
 
@@ -90,6 +106,26 @@ namespace persistent {
     //
     // --------------------------------------------------------------------------
 
+    template<>
+    struct parser<ptree> {
+      static bool read_list_start (ptree&) { return true; }
+      static bool read_list_element_init (ptree&, int) { return true; }
+      static void read_list_element_finish (ptree&) {}
+      static void read_list_end (ptree&) {}
+
+      static void read_property_init (ptree&, std::string&) {}
+      static void read_property_finish (ptree&, const std::string&) {}
+
+      static bool read_next_struct_element (ptree&, std::string&) { return false; }
+      static void read_struct_element_finish (ptree&, const std::string&) {}
+
+      static bool is_ptr_empty (ptree& p) {
+        return p.empty() && p.data().empty();
+      }
+
+      static void skip_value (ptree&) {}
+    };
+
     /// read value
     template<typename T>
     struct read_value_t<ptree, T> {
@@ -99,16 +135,17 @@ namespace persistent {
       }
     };
 
-    /// read vector
-    template<typename T>
-    struct read_vector_t<ptree, T, typename V> {
+    /// read vector, appended or overwritten in a read_into_scope
+    template<typename T, typename V>
+    struct read_vector_t<ptree, T, V> {
       static bool from (ptree& p, V& v) {
-        int i = 0;
-        v.resize(p.size());
+        std::size_t i = read_into_scope::active() ? 0 : v.size();
+        v.resize(i + p.size());
+        bool found = false;
         for (auto& item : p) {
-          read_any(item.second, v[i++]);
+          found |= read_any(item.second, v[i++]);
         }
-        return true;
+        return found;
       }
     };
 
@@ -116,11 +153,15 @@ namespace persistent {
     template<typename T, typename A>
     struct read_array_t<ptree, T, A> {
       static bool from (ptree& p, A& a) {
-        int i = 0;
+        std::size_t i = 0;
+        bool found = false;
         for (auto& item : p) {
-          read_any(item.second, a[i++]);
+          if (i == a.size()) {
+            break;
+          }
+          found |= read_any(item.second, a[i++]);
         }
-        return true;
+        return found;
       }
     };
 
@@ -131,36 +172,82 @@ namespace persistent {
         if (p.size() != 2) {
           throw std::runtime_error(msg_fmt() << "Expected to have 2 childs for pair but got " << p.size());
         }
-        read_any(p.front(), v.first);
-        read_any(p.back(), v.second);
+        read_any(p.front().second, v.first);
+        read_any(p.back().second, v.second);
         return true;
       }
     };
 
+    /// read tagged value
+    template<typename A>
+    struct read_tagged_t<ptree, A> {
+      static bool from (ptree& p, A& a) {
+        if (p.size() != 2) {
+          throw std::runtime_error(msg_fmt() << "Expected to have 2 childs for tagged value but got " << p.size());
+        }
+        std::size_t tag = 0;
+        read_any(p.front().second, tag);
+        a.select(tag);
+        return a.read(p.back().second);
+      }
+    };
+
+    /// read map
+    template<typename M>
+    struct read_map_t<ptree, M> {
+      static bool from (ptree& p, M& m) {
+        typedef typename M::key_type K;
+        typedef typename M::mapped_type V;
+        bool found = false;
+        if (read_into_scope::active()) {
+          m.clear();
+        }
+        reserve(m, m.size() + p.size());
+        for (auto& item : p) {
+          found |= read_any<ptree, V>(item.second, map_inserter_t<M>::element(m, convert<K>::string_to_key(item.first)));
+        }
+        map_inserter_t<M>::finish(m);
+        return found;
+      }
+    };
+
     /// read tuple
     template<typename ... Types>
     struct read_struct_t<ptree, Types...> {
-      static bool from (ptree& p, std::tuple<Types&...> t) {
-        bool found = true;
+      static bool from (ptree& p, std::tuple<Types...>& t, bool* seen = nullptr) {
+        bool found = false;
         for (auto& item : p) {
-          found |= read_attributes_t<sizeof...(Types), ptree, Types...>::property(item.second, item.first, t);
+          found |= read_attributes_t<ptree, Types...>::property(item.second, item.first, t, seen);
         }
         return found;
       }
     };
 
+    /// read property from child
+    template<typename T>
+    struct read_attribute_t<ptree, T> {
+      static bool from (ptree& p, T& t) {
+        auto i = p.find(get_property_name(t));
+        return (i != p.not_found()) && read_property(i->second, t);
+      }
+    };
+
   } // namespace io
 
   // --------------------------------------------------------------------------
+  //
+  // Base for persistent structs with ptree members, T is the derived struct.
+  //
+  template<typename T>
   struct ptree_struct : public persistent_struct {
     typedef persistent_struct super;
 
     void write (io::ptree& pt) const {
-      io::write(pt, *this);
+      io::write(pt, static_cast<const T&>(*this));
     }
 
     bool read (io::ptree& pt) {
-      return io::read(pt, *this);
+      return io::read(pt, static_cast<T&>(*this));
     }
 
   };
@@ -0,0 +1,509 @@
+/**
+* @copyright (c) 2015-2021 Ing. Buero Rothfuss
+*                          Riedlinger Str. 8
+*                          70327 Stuttgart
+*                          Germany
+*                          http://www.rothfuss-web.de
+*
+* @author    <a href="mailto:armin@rothfuss-web.de">Armin Rothfuss</a>
+*
+* Project    persistent lib
+*
+* @brief     C++ struct persistence
+*
+* @license   MIT license. See accompanying file LICENSE.
+*/
+
+#pragma once
+
+// --------------------------------------------------------------------------
+//
+// Common includes
+//
+#include <deque>
+#include <utility>
+#include <limits>
+#include <charconv>
+
+// --------------------------------------------------------------------------
+//
+// Project includes
+//
+#include "persistent_json.h"
+#include "persistent_xml.h"
+#include "persistent_ini.h"
+
+
+namespace persistent {
+
+  namespace io {
+
+    // --------------------------------------------------------------------------
+    //
+    // Transcoding from one format to another.
+    // The parser events of the source are passed directly to the formatter of the target.
+    // A persistent type T describes names and shapes of the document, but no instance of
+    // T is filled. Memory use depends on the nesting depth and the longest string only.
+    //
+    // The source must be hierarchical (json, xml, std::istream). The ini format can be a
+    // target only, as well as the xml attribute mode, which needs all scalar members first.
+    //
+    template<typename Source, typename Target>
+    struct transcoder {
+      transcoder (Source& in, Target& out)
+        : in(in)
+        , out(out)
+      {}
+
+      /// name buffer for the current nesting level
+      std::string& name () {
+        if (depth == names.size()) {
+          names.emplace_back();
+        }
+        return names[depth];
+      }
+
+      Source& in;
+      Target& out;
+      std::deque<std::string> names;  /// one reused name per nesting level, references stay valid
+      std::size_t depth = 0;
+      std::string text;               /// reused buffer for string values
+    };
+
+    /// the value type of a struct property
+    template<typename P>
+    struct property_type;
+
+    template<typename T>
+    struct property_type<detail::attribute<T>> {
+      typedef T type;
+    };
+
+    template<typename T>
+    struct property_type<detail::getter<T>> {
+      typedef std::decay_t<T> type;
+    };
+
+    template<typename T, typename F>
+    struct property_type<detail::setter<T, F>> {
+      typedef std::decay_t<T> type;
+    };
+
+    /// the attributes of a static prototype, to get the names of the members of T.
+    template<typename T>
+    inline auto& prototype_attributes () {
+      static T prototype = {};
+      static auto attr = persistent::attributes(prototype);
+      return attr;
+    }
+
+    /**
+    * transcode any type
+    * type will be detected in later specializations
+    */
+    template<typename Source, typename Target, typename T, typename Enable = void>
+    struct transcode_any_t {
+      static bool from (transcoder<Source, Target>& tc) {
+        T t = {};
+        if (!read_any(tc.in, t)) {
+          return false;
+        }
+        write_any(tc.out, static_cast<const T&>(t));
+        return true;
+      }
+    };
+
+    template<typename T, typename Source, typename Target>
+    inline bool transcode_any (transcoder<Source, Target>& tc) {
+      return transcode_any_t<Source, Target, T>::from(tc);
+    }
+
+    /// transcode string with the reused buffer
+    template<typename Source, typename Target>
+    struct transcode_any_t<Source, Target, std::string> {
+      static bool from (transcoder<Source, Target>& tc) {
+        tc.text.clear();
+        if (!read_any(tc.in, tc.text)) {
+          return false;
+        }
+        write_any(tc.out, static_cast<const std::string&>(tc.text));
+        return true;
+      }
+    };
+
+    /// transcode views through the string buffer
+    template<typename Source, typename Target>
+    struct transcode_any_t<Source, Target, std::string_view>
+      : public transcode_any_t<Source, Target, std::string> {};
+
+    /// transcode list elements, at most S elements
+    template<typename Source, typename Target, typename T, std::size_t S>
+    struct transcode_list_t {
+      static bool from (transcoder<Source, Target>& tc) {
+        if (!parser<Source>::read_list_start(tc.in)) {
+          return false;
+        }
+        formatter<Target>::write_list_start(tc.out);
+        bool found = false;
+        for (std::size_t num = 0; (num < S) && parser<Source>::read_list_element_init(tc.in, static_cast<int>(num)); ++num) {
+          formatter<Target>::write_list_element_init(tc.out, static_cast<int>(num));
+          found |= transcode_any<T>(tc);
+          formatter<Target>::write_list_element_finish(tc.out);
+          parser<Source>::read_list_element_finish(tc.in);
+        }
+        parser<Source>::read_list_end(tc.in);
+        formatter<Target>::write_list_end(tc.out);
+        return found;
+      }
+    };
+
+    /// detect vector
+    template<typename Source, typename Target, typename T, typename A>
+    struct transcode_any_t<Source, Target, std::vector<T, A>>
+      : public transcode_list_t<Source, Target, T, std::numeric_limits<std::size_t>::max()> {};
+
+    /// detect set, the elements are passed in source order
+    template<typename Source, typename Target, typename S>
+    struct transcode_any_t<Source, Target, S, typename std::enable_if<is_set<S>::value>::type>
+      : public transcode_list_t<Source, Target, typename S::value_type, std::numeric_limits<std::size_t>::max()> {};
+
+    /// detect array
+    template<typename Source, typename Target, typename T, std::size_t S>
+    struct transcode_any_t<Source, Target, std::array<T, S>>
+      : public transcode_list_t<Source, Target, T, S> {};
+
+    /// detect pair
+    template<typename Source, typename Target, typename T1, typename T2>
+    struct transcode_any_t<Source, Target, std::pair<T1, T2>> {
+      static bool from (transcoder<Source, Target>& tc) {
+        if (!parser<Source>::read_list_start(tc.in)) {
+          return false;
+        }
+        formatter<Target>::write_list_start(tc.out);
+        element<T1>(tc, 0);
+        element<T2>(tc, 1);
+        parser<Source>::read_list_end(tc.in);
+        formatter<Target>::write_list_end(tc.out);
+        return true;
+      }
+
+    private:
+      template<typename T>
+      static void element (transcoder<Source, Target>& tc, int num) {
+        parser<Source>::read_list_element_init(tc.in, num);
+        formatter<Target>::write_list_element_init(tc.out, num);
+        if (!transcode_any<T>(tc)) {
+          throw std::runtime_error(msg_fmt() << "Could not read pair element " << num);
+        }
+        formatter<Target>::write_list_element_finish(tc.out);
+        parser<Source>::read_list_element_finish(tc.in);
+      }
+    };
+
+    /// transcode the pointee of a pointer
+    template<typename Source, typename Target, typename T>
+    struct transcode_ptr_t {
+      static bool from (transcoder<Source, Target>& tc) {
+        if (parser<Source>::is_ptr_empty(tc.in)) {
+          formatter<Target>::write_empty_ptr(tc.out);
+          return false;
+        }
+        return transcode_any<T>(tc);
+      }
+    };
+
+    /// transcode a shared pointer, inside a shared scope as list of the id and the pointee
+    template<typename Source, typename Target, typename Value>
+    struct transcode_shared_t {
+      static bool from (transcoder<Source, Target>& tc) {
+        if (!shared_scope::active()) {
+          return Value::from(tc);
+        }
+        if (parser<Source>::is_ptr_empty(tc.in)) {
+          formatter<Target>::write_empty_ptr(tc.out);
+          return false;
+        }
+        if (!parser<Source>::read_list_start(tc.in)) {
+          return false;
+        }
+        formatter<Target>::write_list_start(tc.out);
+        parser<Source>::read_list_element_init(tc.in, 0);
+        formatter<Target>::write_list_element_init(tc.out, 0);
+        std::size_t id = 0;
+        if (!read_any(tc.in, id)) {
+          throw std::runtime_error("Could not read shared id");
+        }
+        write_any(tc.out, static_cast<const std::size_t&>(id));
+        formatter<Target>::write_list_element_finish(tc.out);
+        parser<Source>::read_list_element_finish(tc.in);
+        parser<Source>::read_list_element_init(tc.in, 1);
+        formatter<Target>::write_list_element_init(tc.out, 1);
+        Value::from(tc);
+        formatter<Target>::write_list_element_finish(tc.out);
+        parser<Source>::read_list_element_finish(tc.in);
+        parser<Source>::read_list_end(tc.in);
+        formatter<Target>::write_list_end(tc.out);
+        return true;
+      }
+    };
+
+    /// detect shared
+    template<typename Source, typename Target, typename T>
+    struct transcode_any_t<Source, Target, std::shared_ptr<T>, typename std::enable_if<!is_registered_base<T>::value>::type>
+      : public transcode_shared_t<Source, Target, transcode_ptr_t<Source, Target, T>> {};
+
+    /// detect unique
+    template<typename Source, typename Target, typename T, typename D>
+    struct transcode_any_t<Source, Target, std::unique_ptr<T, D>>
+      : public transcode_ptr_t<Source, Target, T> {};
+
+    /// detect optional
+    template<typename Source, typename Target, typename T>
+    struct transcode_any_t<Source, Target, std::optional<T>>
+      : public transcode_ptr_t<Source, Target, T> {};
+
+    /// transcode a tagged value, the value is transcoded through a table selected by the tag
+    template<typename Source, typename Target, typename ... Types>
+    struct transcode_tagged_t {
+      typedef bool (*alternative) (transcoder<Source, Target>&);
+
+      static bool from (transcoder<Source, Target>& tc) {
+        static constexpr alternative table[] = { &transcode_any<Types, Source, Target>... };
+        if (!parser<Source>::read_list_start(tc.in)) {
+          return false;
+        }
+        formatter<Target>::write_list_start(tc.out);
+        parser<Source>::read_list_element_init(tc.in, 0);
+        formatter<Target>::write_list_element_init(tc.out, 0);
+        std::size_t idx = 0;
+        if (!read_any(tc.in, idx) || (idx >= sizeof...(Types))) {
+          throw std::runtime_error("Could not read type tag");
+        }
+        write_any(tc.out, static_cast<const std::size_t&>(idx));
+        formatter<Target>::write_list_element_finish(tc.out);
+        parser<Source>::read_list_element_finish(tc.in);
+        parser<Source>::read_list_element_init(tc.in, 1);
+        formatter<Target>::write_list_element_init(tc.out, 1);
+        const bool found = table[idx](tc);
+        formatter<Target>::write_list_element_finish(tc.out);
+        parser<Source>::read_list_element_finish(tc.in);
+        parser<Source>::read_list_end(tc.in);
+        formatter<Target>::write_list_end(tc.out);
+        return found;
+      }
+    };
+
+    /// detect variant, tagged by the index of the alternative
+    template<typename Source, typename Target, typename ... Types>
+    struct transcode_any_t<Source, Target, std::variant<Types...>>
+      : public transcode_tagged_t<Source, Target, Types...> {};
+
+    /// transcode pointer to a registered base, tagged by the derived type
+    template<typename Source, typename Target, typename List>
+    struct transcode_polymorphic_t;
+
+    template<typename Source, typename Target, typename ... Types>
+    struct transcode_polymorphic_t<Source, Target, type_list<Types...>> {
+      static bool from (transcoder<Source, Target>& tc) {
+        if (parser<Source>::is_ptr_empty(tc.in)) {
+          formatter<Target>::write_empty_ptr(tc.out);
+          return false;
+        }
+        return transcode_tagged_t<Source, Target, Types...>::from(tc);
+      }
+    };
+
+    /// detect shared pointer to a registered base
+    template<typename Source, typename Target, typename T>
+    struct transcode_any_t<Source, Target, std::shared_ptr<T>, typename std::enable_if<is_registered_base<T>::value>::type>
+      : public transcode_shared_t<Source, Target, transcode_polymorphic_t<Source, Target, typename derived_types<T>::types>> {};
+
+    /**
+     * transcode named elements of structs, maps and tuples in source order.
+     * Element::from(tc, name) transcodes the value of a known element and returns false for unknown names.
+     */
+    template<typename Source, typename Target, typename Element>
+    struct transcode_elements_t {
+      static bool from (transcoder<Source, Target>& tc) {
+        std::string& name = tc.name();
+        ++tc.depth;
+        formatter<Target>::write_struct_start(tc.out);
+        bool found = false;
+        bool first = true;
+        try {
+          name.clear();
+          while (parser<Source>::read_next_struct_element(tc.in, name)) {
+            if (Element::is(name)) {
+              if (!first) {
+                formatter<Target>::write_members_delemiter(tc.out);
+              }
+              first = false;
+              formatter<Target>::write_property_init(tc.out, name);
+              found |= Element::from(tc, name);
+              formatter<Target>::write_property_finish(tc.out, name);
+            } else {
+              // unknown key -> skip the value
+              parser<Source>::skip_value(tc.in);
+            }
+            parser<Source>::read_struct_element_finish(tc.in, name);
+            name.clear();
+          }
+        } catch (std::exception& ex) {
+          --tc.depth;
+          throw std::runtime_error(msg_fmt() << ex.what() << " in element '" << name << "'");
+        }
+        formatter<Target>::write_struct_end(tc.out);
+        --tc.depth;
+        return found;
+      }
+    };
+
+    /// elements of a persistent struct
+    template<typename T, typename Source, typename Target>
+    struct transcode_struct_element {
+      typedef std::remove_reference_t<decltype(prototype_attributes<T>())> tuple_type;
+      typedef std::make_index_sequence<std::tuple_size<tuple_type>::value> indices;
+
+      static bool is (const std::string& name) {
+        return is_name(name, indices());
+      }
+
+      static bool from (transcoder<Source, Target>& tc, const std::string& name) {
+        return from(tc, name, indices());
+      }
+
+    private:
+      template<std::size_t ... I>
+      static bool is_name (const std::string& name, std::index_sequence<I...>) {
+        const auto& attr = prototype_attributes<T>();
+        return ((name == get_property_name(std::get<I>(attr))) || ...);
+      }
+
+      template<std::size_t ... I>
+      static bool from (transcoder<Source, Target>& tc, const std::string& name, std::index_sequence<I...>) {
+        const auto& attr = prototype_attributes<T>();
+        bool found = false;
+        ((name == get_property_name(std::get<I>(attr)) ?
+          (found = transcode_any<typename property_type<std::tuple_element_t<I, tuple_type>>::type>(tc), true) : false) || ...);
+        return found;
+      }
+    };
+
+    /// detect struct
+    template<typename Source, typename Target, typename T>
+    struct transcode_any_t<Source, Target, T, typename std::enable_if<is_persistent<T>::value>::type>
+      : public transcode_elements_t<Source, Target, transcode_struct_element<T, Source, Target>> {};
+
+    /// elements of a map
+    template<typename V, typename Source, typename Target>
+    struct transcode_map_element {
+      static bool is (const std::string&) {
+        return true;
+      }
+
+      static bool from (transcoder<Source, Target>& tc, const std::string&) {
+        return transcode_any<V>(tc);
+      }
+    };
+
+    /// detect map
+    template<typename Source, typename Target, typename M>
+    struct transcode_any_t<Source, Target, M, typename std::enable_if<is_map<M>::value>::type>
+      : public transcode_elements_t<Source, Target, transcode_map_element<typename M::mapped_type, Source, Target>> {};
+
+    /// elements of a tuple, named by index
+    template<typename Source, typename Target, typename ... Types>
+    struct transcode_tuple_element {
+      typedef std::index_sequence_for<Types...> indices;
+
+      static bool is (const std::string& name) {
+        return index(name) < sizeof...(Types);
+      }
+
+      static bool from (transcoder<Source, Target>& tc, const std::string& name) {
+        return from(tc, index(name), indices());
+      }
+
+    private:
+      static std::size_t index (const std::string& name) {
+        std::size_t i = sizeof...(Types);
+        const auto r = std::from_chars(name.data(), name.data() + name.size(), i);
+        return ((r.ec == std::errc()) && (r.ptr == name.data() + name.size())) ? i : sizeof...(Types);
+      }
+
+      template<std::size_t ... I>
+      static bool from (transcoder<Source, Target>& tc, std::size_t i, std::index_sequence<I...>) {
+        bool found = false;
+        (((i == I) ? (found = transcode_any<Types>(tc), true) : false) || ...);
+        return found;
+      }
+    };
+
+    /// detect tuple
+    template<typename Source, typename Target, typename ... Types>
+    struct transcode_any_t<Source, Target, std::tuple<Types...>>
+      : public transcode_elements_t<Source, Target, transcode_tuple_element<Source, Target, Types...>> {};
+
+    /// convenience helper
+    template<typename T, typename Source, typename Target>
+    inline bool transcode (Source& in, Target& out) {
+      transcoder<Source, Target> tc(in, out);
+      return transcode_any<T>(tc);
+    }
+
+    // --------------------------------------------------------------------------
+    //
+    // transcoding between the stream formats
+    //
+    template<typename T, typename Target>
+    inline bool transcode_from_json (std::istream& is, Target& out) {
+      json_parser_context in(is);
+      return transcode<T>(in, out);
+    }
+
+    template<typename T, typename Target>
+    inline bool transcode_from_xml (std::istream& is, Target& out) {
+      xml_parser_context in(is);
+      in.check_token(xml::s_header);
+      in.check_token(xml::s_body);
+      const bool found = transcode<T>(in, out);
+      in.check_token(xml::s_nbody);
+      return found;
+    }
+
+    template<typename T>
+    inline bool json_to_xml (std::istream& is, std::ostream& os, bool beautify = true) {
+      xml_formatter_context out(os, beautify);
+      out.os << xml::s_header;
+      out.endl().os << xml::s_body;
+      out.endl().inc();
+      const bool found = transcode_from_json<T>(is, out);
+      out.dec();
+      os << xml::s_nbody;
+      out.endl();
+      return found;
+    }
+
+    template<typename T>
+    inline bool json_to_ini (std::istream& is, std::ostream& os, bool sections = false) {
+      ini_formatter_context out(os, sections);
+      return transcode_from_json<T>(is, out);
+    }
+
+    template<typename T>
+    inline bool xml_to_json (std::istream& is, std::ostream& os, bool beautify = true) {
+      json_formatter_context out(os, beautify);
+      return transcode_from_xml<T>(is, out);
+    }
+
+    template<typename T>
+    inline bool xml_to_ini (std::istream& is, std::ostream& os, bool sections = false) {
+      ini_formatter_context out(os, sections);
+      return transcode_from_xml<T>(is, out);
+    }
+
+  } // namespace io
+
+} // namespace persistent
+
+// --------------------------------------------------------------------------
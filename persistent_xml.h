@@ -21,6 +21,22 @@
 // Common includes
 //
 #include <iostream>
+#include <limits>
+#include <string_view>
+#include <charconv>
+#include <cstring>
+#include <typeinfo>
+#include <iterator>
+#include <tuple>
+#include <cstdint>
+
+#if !defined(PERSISTENT_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2)))
+# define PERSISTENT_XML_SSE2
+# include <emmintrin.h>
+# ifdef _MSC_VER
+#  include <intrin.h>
+# endif
+#endif
 
 // --------------------------------------------------------------------------
 //
@@ -48,8 +64,156 @@ namespace persistent {
       const std::string s_header = "<?xml version=\"1.0\" encoding=\"utf-8\"?>";
       const std::string s_body = "<body>";
       const std::string s_nbody = "</body>";
+      const std::string s_body_name = "body";
+      const std::string s_li_name = "li";
+
+      /// types written as xml attribute in attribute mode
+      template<typename T>
+      struct is_scalar : std::integral_constant<bool, std::is_arithmetic<T>::value ||
+                                                      std::is_same<T, std::string>::value ||
+                                                      std::is_same<T, std::string_view>::value> {};
+
+      /// properties with a scalar value
+      template<typename P>
+      struct is_scalar_property : std::false_type {};
+
+      template<typename T>
+      struct is_scalar_property<detail::attribute<T>> : is_scalar<std::decay_t<T>> {};
+
+      template<typename T>
+      struct is_scalar_property<detail::getter<T>> : is_scalar<std::decay_t<T>> {};
+
+      /// characters which are written as entity.
+      inline bool is_special (char c) {
+        return (c == '<') || (c == '>') || (c == '&') || (c == '"');
+      }
+
+      /// find the first character in [first, last) which is written as entity.
+      inline const char* find_special (const char* first, const char* last) {
+#ifdef PERSISTENT_XML_SSE2
+        // check 16 characters at once
+        const __m128i lt = _mm_set1_epi8('<');
+        const __m128i gt = _mm_set1_epi8('>');
+        const __m128i amp = _mm_set1_epi8('&');
+        const __m128i quot = _mm_set1_epi8('"');
+        for (; last - first >= 16; first += 16) {
+          const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+          const __m128i m = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, lt), _mm_cmpeq_epi8(v, gt)),
+                                         _mm_or_si128(_mm_cmpeq_epi8(v, amp), _mm_cmpeq_epi8(v, quot)));
+          const int mask = _mm_movemask_epi8(m);
+          if (mask) {
+# ifdef _MSC_VER
+            unsigned long i;
+            _BitScanForward(&i, mask);
+            return first + i;
+# else
+            return first + __builtin_ctz(mask);
+# endif
+          }
+        }
+#endif
+        while ((first != last) && !is_special(*first)) {
+          ++first;
+        }
+        return first;
+      }
+
+      /// write text with the predefined entities, runs without special characters are copied as block.
+      inline void write_escaped (std::ostream& os, std::string_view text) {
+        const char* first = text.data();
+        const char* last = first + text.size();
+        while (first != last) {
+          const char* next = find_special(first, last);
+          os.write(first, next - first);
+          if (next == last) {
+            break;
+          }
+          switch (*next) {
+            case '<': os.write("&lt;", 4);    break;
+            case '>': os.write("&gt;", 4);    break;
+            case '&': os.write("&amp;", 5);   break;
+            case '"': os.write("&quot;", 6);  break;
+          }
+          first = next + 1;
+        }
+      }
+
+      /**
+       * decode predefined entities and character references of [first, last) to out.
+       * The decoded text is never longer than the source, so out may be first.
+       * Returns the end of the decoded text.
+       */
+      inline char* unescape (const char* first, const char* last, char* out) {
+        while (first != last) {
+          const char* amp = static_cast<const char*>(std::memchr(first, '&', last - first));
+          const char* next = amp ? amp : last;
+          if (out != first) {
+            std::memmove(out, first, next - first);
+          }
+          out += next - first;
+          if (next == last) {
+            break;
+          }
+          const char* semi = static_cast<const char*>(std::memchr(amp, ';', last - amp));
+          if (!semi) {
+            throw std::runtime_error(msg_fmt() << "Unterminated entity '" << std::string_view(amp, last - amp) << "'");
+          }
+          const std::string_view entity(amp + 1, semi - amp - 1);
+          if (entity == "lt") {
+            *out++ = '<';
+          } else if (entity == "gt") {
+            *out++ = '>';
+          } else if (entity == "amp") {
+            *out++ = '&';
+          } else if (entity == "quot") {
+            *out++ = '"';
+          } else if (entity == "apos") {
+            *out++ = '\'';
+          } else if ((entity.size() > 1) && (entity[0] == '#')) {
+            const bool hex = (entity[1] == 'x') || (entity[1] == 'X');
+            const char* begin = entity.data() + (hex ? 2 : 1);
+            std::uint32_t cp = 0;
+            const auto r = std::from_chars(begin, semi, cp, hex ? 16 : 10);
+            if ((r.ec != std::errc()) || (r.ptr != semi) || (begin == semi)) {
+              throw std::runtime_error(msg_fmt() << "Invalid character reference '&" << entity << ";'");
+            }
+            out = write_utf8(cp, out);
+          } else {
+            throw std::runtime_error(msg_fmt() << "Unknown entity '&" << entity << ";'");
+          }
+          first = semi + 1;
+        }
+        return out;
+      }
+
+      /// decode the entities of t in place.
+      inline void unescape (std::string& t) {
+        char* data = t.data();
+        t.resize(unescape(data, data + t.size(), data) - data);
+      }
+
+      /// write a scalar as element text or attribute value
+      template<typename T>
+      inline void write_text (std::ostream& os, const T& t) {
+        write_value(os, t);
+      }
+
+      inline void write_text (std::ostream& os, const std::string& t) {
+        write_escaped(os, t);
+      }
+
+      inline void write_text (std::ostream& os, std::string_view t) {
+        write_escaped(os, t);
+      }
+
+      inline void write_text (std::ostream& os, char t) {
+        write_escaped(os, std::string_view(&t, 1));
+      }
     }
 
+    template<>
+    struct table_driven<xml_formatter_context> : std::true_type {};
+
     template<>
     struct formatter<xml_formatter_context> {
 
@@ -94,6 +258,25 @@ namespace persistent {
       }
     };
 
+    template<>
+    struct key_fragments<xml_formatter_context> {
+      static constexpr bool rendered = true;
+
+      /// tags don't depend on beautify, indentation is written around them
+      static key_fragment render (const std::string& name, bool) {
+        return { "<" + name + ">", "</" + name + ">" };
+      }
+
+      static void write_property_init (xml_formatter_context& out, const key_fragment& key) {
+        out.fill().inc().os.write(key.init.data(), key.init.size());
+      }
+
+      static void write_property_finish (xml_formatter_context& out, const key_fragment& key) {
+        out.dec().fill().os.write(key.finish.data(), key.finish.size());
+        out.endl();
+      }
+    };
+
     template<typename T>
     struct write_value_t<xml_formatter_context, T> {
       static void to (xml_formatter_context& out, const T& t) {
@@ -101,15 +284,157 @@ namespace persistent {
       }
     };
 
+    template<>
+    struct write_value_t<xml_formatter_context, const char> {
+      static void to (xml_formatter_context& out, const char t) {
+        xml::write_text(out.os, t);
+      }
+    };
+
     template<>
     struct write_value_t<xml_formatter_context, const std::string> {
       static void to (xml_formatter_context& out, const std::string& t) {
-        out.os << t;
+        xml::write_escaped(out.os, t);
+      }
+    };
+
+    template<>
+    struct write_value_t<xml_formatter_context, const std::string_view> {
+      static void to (xml_formatter_context& out, const std::string_view& t) {
+        xml::write_escaped(out.os, t);
+      }
+    };
+
+    // --------------------------------------------------------------------------
+    //
+    // xml ostream in attribute mode:
+    // scalar members of a struct are written as attributes of the struct element,
+    // elements without content are self-closing and lists are a sequence of <li> elements.
+    //
+    struct xml_attribute_formatter_context : public xml_formatter_context {
+      xml_attribute_formatter_context (std::ostream& os, bool beautify = true)
+        : xml_formatter_context(os, beautify)
+      {}
+
+      bool open = false;  /// the current start tag is not closed yet and takes attributes
+
+      void close_tag (bool new_line) {
+        if (open) {
+          os << '>';
+          open = false;
+          if (new_line) {
+            endl();
+          }
+        }
       }
     };
 
+    template<>
+    struct formatter<xml_attribute_formatter_context> {
+
+      static void write_list_start (xml_attribute_formatter_context&) {
+      }
+
+      static void write_list_element_init (xml_attribute_formatter_context& out, int) {
+        write_property_init(out, xml::s_li_name);
+      }
+
+      static void write_list_element_finish (xml_attribute_formatter_context& out) {
+        write_property_finish(out, xml::s_li_name);
+      }
+
+      static void write_list_end (xml_attribute_formatter_context&) {
+      }
+
+      static void write_members_delemiter (xml_attribute_formatter_context&) {
+      }
+
+      static void write_property_init (xml_attribute_formatter_context& out, const std::string& name) {
+        out.close_tag(true);
+        out.fill().inc().os << '<' << name;
+        out.open = true;
+      }
+
+      static void write_property_finish (xml_attribute_formatter_context& out, const std::string& name) {
+        out.dec();
+        if (out.open) {
+          out.os << "/>";
+          out.open = false;
+        } else {
+          out.fill().os << "</" << name << '>';
+        }
+        out.endl();
+      }
+
+      static void write_struct_start (xml_attribute_formatter_context&) {
+      }
+
+      static void write_struct_end (xml_attribute_formatter_context&) {
+      }
+
+      static void write_empty_ptr (xml_attribute_formatter_context&) {
+      }
+    };
+
+    template<typename T>
+    struct write_value_t<xml_attribute_formatter_context, T> {
+      static void to (xml_attribute_formatter_context& out, const T& t) {
+        out.close_tag(false);
+        xml::write_text(out.os, t);
+      }
+    };
+
+    /// write a struct member in the attribute or in the element pass
+    template<typename P, typename Enable = void>
+    struct write_xml_member_t {
+      static void attribute (xml_attribute_formatter_context&, const P&) {}
+
+      static void element (xml_attribute_formatter_context& out, const P& p, bool) {
+        write_any(out, p);
+      }
+    };
+
+    template<typename P>
+    struct write_xml_member_t<P, typename std::enable_if<xml::is_scalar_property<P>::value>::type> {
+      static void attribute (xml_attribute_formatter_context& out, const P& p) {
+        out.os << ' ' << get_property_name(p) << "=\"";
+        xml::write_text(out.os, get_property_value(p));
+        out.os << '"';
+      }
+
+      static void element (xml_attribute_formatter_context& out, const P& p, bool as_attribute) {
+        if (!as_attribute) {
+          write_any(out, p);
+        }
+      }
+    };
+
+    /// write struct, scalar members as attributes first, then all other members as elements
+    template<typename ... Types>
+    struct write_struct_t<xml_attribute_formatter_context, Types...> {
+      static void to (xml_attribute_formatter_context& out, const std::tuple<Types...>& t) {
+        const bool as_attribute = out.open;
+        std::apply([&] (const Types&... m) {
+          if (as_attribute) {
+            (write_xml_member_t<Types>::attribute(out, m), ...);
+          }
+          (write_xml_member_t<Types>::element(out, m, as_attribute), ...);
+        }, t);
+      }
+    };
+
+    // --------------------------------------------------------------------------
     template<typename T>
-    void write_xml (std::ostream& os, const T& t, bool beautify = true) {
+    void write_xml (std::ostream& os, const T& t, bool beautify = true, bool attributes = false) {
+      if (attributes) {
+        xml_attribute_formatter_context out(os, beautify);
+        out.os << xml::s_header;
+        out.endl();
+        formatter<xml_attribute_formatter_context>::write_property_init(out, xml::s_body_name);
+        write(out, t);
+        formatter<xml_attribute_formatter_context>::write_property_finish(out, xml::s_body_name);
+        return;
+      }
       xml_formatter_context out(os, beautify);
       out.os << xml::s_header;
       out.endl().os << xml::s_body;
@@ -120,6 +445,31 @@ namespace persistent {
       out.endl();
     }
 
+    // --------------------------------------------------------------------------
+    namespace xml {
+
+      /// true if token is the closing tag '</name>'.
+      inline bool is_end_tag (std::string_view token, std::string_view name) {
+        return (token.size() == name.size() + 3) && (token.compare(0, 2, "</") == 0) &&
+               (token.back() == '>') && (token.compare(2, name.size(), name) == 0);
+      }
+
+      inline bool is_end_tag (std::string_view token) {
+        return token.compare(0, 2, "</") == 0;
+      }
+
+      /// true if token is an opening tag '<name>'.
+      inline bool is_start_tag (std::string_view token) {
+        return (token.size() > 2) && (token.front() == '<') && (token.back() == '>') && (token[1] != '/');
+      }
+
+      /// the name of the tag '<name>'.
+      inline std::string_view tag_name (std::string_view token) {
+        return token.substr(1, token.size() - 2);
+      }
+
+    } // namespace xml
+
     // --------------------------------------------------------------------------
     //
     // specializations for xml formatted istream
@@ -131,6 +481,10 @@ namespace persistent {
 
       std::istream& is;
 
+      bool good () const {
+        return is.good();
+      }
+
       const std::string& next_token () {
         if (token_empty()) {
           next();
@@ -148,13 +502,20 @@ namespace persistent {
         return token;
       }
 
-      void check_token (const std::string& expected) {
+      void check_token (std::string_view expected) {
         if (next_token() != expected) {
           throw std::runtime_error(msg_fmt() << "Expected '" << expected << "' but got '" << token << "'");
         }
         clear_token();
       }
 
+      void check_end_tag (std::string_view name) {
+        if (!xml::is_end_tag(next_token(), name)) {
+          throw std::runtime_error(msg_fmt() << "Expected '</" << name << ">' but got '" << token << "'");
+        }
+        clear_token();
+      }
+
       void clear_token () {
         token.clear();
       }
@@ -163,15 +524,189 @@ namespace persistent {
         return token.empty();
       }
 
+      /// skip text and nested elements up to the closing tag of the current element,
+      /// the closing tag becomes the next token.
+      void skip_element () {
+        typedef std::char_traits<char> traits;
+        int depth = 0;
+        if (!token_empty()) {
+          if (xml::is_end_tag(token)) {
+            return;
+          }
+          depth = token.compare(token.size() - 2, 2, "/>") == 0 ? 0 : 1;
+          clear_token();
+        }
+        std::streambuf* buf = is.rdbuf();
+        while (is.ignore(std::numeric_limits<std::streamsize>::max(), '<').good()) {
+          if (buf->sgetc() == '/') {
+            if (depth == 0) {
+              token = '<';
+              for (auto c = buf->sbumpc(); !traits::eq_int_type(c, traits::eof()); c = buf->sbumpc()) {
+                token.push_back(traits::to_char_type(c));
+                if (c == '>') {
+                  return;
+                }
+              }
+              break;
+            }
+            --depth;
+            is.ignore(std::numeric_limits<std::streamsize>::max(), '>');
+          } else {
+            const auto first = buf->sgetc();
+            auto last = first;
+            for (auto c = buf->sbumpc(); !traits::eq_int_type(c, traits::eof()) && (c != '>'); c = buf->sbumpc()) {
+              last = c;
+            }
+            if ((last != '/') && (first != '?') && (first != '!')) {
+              ++depth;
+            }
+          }
+        }
+        is.setstate(std::ios_base::eofbit);
+      }
+
     private:
       std::string token;
 
     };
 
-    template<>
-    struct parser<xml_parser_context> {
+    // --------------------------------------------------------------------------
+    //
+    // xml parser context for contiguous input.
+    // Tokens and text are views into the input, nothing is copied until a value is assigned.
+    //
+    struct xml_buffer_context {
+      xml_buffer_context (const char* begin, const char* end)
+        : pos(begin)
+        , end(end)
+        , eof(false)
+      {}
+
+      explicit xml_buffer_context (std::string_view data)
+        : xml_buffer_context(data.data(), data.data() + data.size())
+      {}
+
+      bool good () const {
+        return !eof;
+      }
+
+      std::string_view next_token () {
+        if (token_empty()) {
+          next();
+        }
+        return token;
+      }
+
+      std::string_view next () {
+        skip_ws();
+        token = {};
+        if (pos == end) {
+          eof = true;
+        } else if (*pos == '<') {
+          const char* close = find('>');
+          if (close == end) {
+            eof = true;
+            token = std::string_view(pos, end - pos);
+            pos = end;
+          } else {
+            token = std::string_view(pos, close + 1 - pos);
+            pos = close + 1;
+          }
+        }
+        return token;
+      }
+
+      /// the text up to the next tag.
+      std::string_view text () {
+        const char* first = pos;
+        pos = find('<');
+        return std::string_view(first, pos - first);
+      }
+
+      void check_token (std::string_view expected) {
+        if (next_token() != expected) {
+          throw std::runtime_error(msg_fmt() << "Expected '" << expected << "' but got '" << token << "'");
+        }
+        clear_token();
+      }
+
+      void check_end_tag (std::string_view name) {
+        if (!xml::is_end_tag(next_token(), name)) {
+          throw std::runtime_error(msg_fmt() << "Expected '</" << name << ">' but got '" << token << "'");
+        }
+        clear_token();
+      }
+
+      void clear_token () {
+        token = {};
+      }
+
+      bool token_empty () const {
+        return token.empty();
+      }
+
+      /// skip text and nested elements up to the closing tag of the current element,
+      /// the closing tag becomes the next token.
+      void skip_element () {
+        int depth = 0;
+        if (!token_empty()) {
+          if (xml::is_end_tag(token)) {
+            return;
+          }
+          depth = token.compare(token.size() - 2, 2, "/>") == 0 ? 0 : 1;
+          clear_token();
+        }
+        for (pos = find('<'); pos != end; pos = find('<')) {
+          const char* close = find('>');
+          if (close == end) {
+            break;
+          }
+          const std::string_view tag(pos, close + 1 - pos);
+          pos = close + 1;
+          if (xml::is_end_tag(tag)) {
+            if (depth == 0) {
+              token = tag;
+              return;
+            }
+            --depth;
+          } else if ((tag[tag.size() - 2] != '/') && (tag[1] != '?') && (tag[1] != '!')) {
+            ++depth;
+          }
+        }
+        pos = end;
+        eof = true;
+      }
+
+    private:
+      const char* find (char c) const {
+        const char* p = static_cast<const char*>(std::memchr(pos, c, end - pos));
+        return p ? p : end;
+      }
+
+      void skip_ws () {
+        while ((pos != end) && ::isspace(static_cast<unsigned char>(*pos))) {
+          ++pos;
+        }
+      }
+
+      const char* pos;
+      const char* end;
+      std::string_view token;
+      bool eof;
+
+    public:
+      scratch_arena* scratch = nullptr;  /// borrowed read of std::string_view members if set
 
-      static bool read_list_start (xml_parser_context& in) {
+    };
+
+    // --------------------------------------------------------------------------
+    //
+    // common parser for both xml contexts
+    //
+    template<typename Context>
+    struct xml_parser {
+
+      static bool read_list_start (Context& in) {
         if (in.next_token() == "<ol>") {
           in.clear_token();
           return true;
@@ -179,7 +714,7 @@ namespace persistent {
         return false;
       }
 
-      static bool read_list_element_init (xml_parser_context& in, int) {
+      static bool read_list_element_init (Context& in, int) {
         if (in.next_token() == "<li>") {
           in.clear_token();
           return true;
@@ -187,48 +722,64 @@ namespace persistent {
         return false;
       }
 
-      static void read_list_element_finish (xml_parser_context& in) {
+      static void read_list_element_finish (Context& in) {
         in.check_token("</li>");
       }
 
-      static void read_list_end (xml_parser_context& in) {
+      static void read_list_end (Context& in) {
         in.check_token("</ol>");
       }
 
-      static void read_property_init (xml_parser_context& in, std::string& key) {
-        const std::string& token = in.next_token();
+      static void read_property_init (Context& in, std::string& key) {
+        const std::string_view token = in.next_token();
         if ((token.size() < 3) || (token.front() != '<') || (token.back() != '>')) {
           throw std::runtime_error(msg_fmt() << "Expected '<xyz>' but got '" << token << "'");
         }
-        key = token.substr(1, token.size() - 2);
+        key.assign(xml::tag_name(token));
         in.clear_token();
       }
 
-      static void read_property_finish (xml_parser_context& in, const std::string& key) {
-        in.check_token("</" + key + ">");
+      static void read_property_finish (Context& in, const std::string& key) {
+        in.check_end_tag(key);
       }
 
-      static bool read_next_struct_element (xml_parser_context& in, std::string& key) {
-        const std::string& token = in.next_token();
-        if (in.is.good() && (token.compare(0, 2, "</") != 0) &&
-            (token.size() > 2) && (token.front() == '<') && (token.back() == '>')) {
-          key = token.substr(1, token.size() - 2);
+      static bool read_next_struct_element (Context& in, std::string& key) {
+        const std::string_view token = in.next_token();
+        if (in.good() && xml::is_start_tag(token)) {
+          key.assign(xml::tag_name(token));
           in.clear_token();
           return true;
         }
         return false;
       }
 
-      static void read_struct_element_finish (xml_parser_context& in, const std::string& key) {
-        in.check_token("</" + key + ">");
+      static void read_struct_element_finish (Context& in, const std::string& key) {
+        in.check_end_tag(key);
+      }
+
+      static bool is_ptr_empty (Context& in) {
+        const std::string_view token = in.next_token();
+        return in.good() && xml::is_end_tag(token);
       }
 
-      static bool is_ptr_empty (xml_parser_context& in) {
-        const std::string& token = in.next_token();
-        return in.is.good() && (token.compare(0, 2, "</") == 0);
+      static void skip_value (Context& in) {
+        in.skip_element();
       }
     };
 
+    template<>
+    struct table_driven<xml_parser_context> : std::true_type {};
+
+    template<>
+    struct parser<xml_parser_context> : public xml_parser<xml_parser_context> {};
+
+    template<>
+    struct table_driven<xml_buffer_context> : std::true_type {};
+
+    template<>
+    struct parser<xml_buffer_context> : public xml_parser<xml_buffer_context> {};
+
+    // --------------------------------------------------------------------------
     template<typename T>
     struct read_value_t<xml_parser_context, T> {
       static bool from (xml_parser_context& in, T& t) {
@@ -247,6 +798,7 @@ namespace persistent {
           if (in.is.good()) {
             in.is.putback('<');
           }
+          xml::unescape(t);
           return true;
         }
         return false;
@@ -258,15 +810,317 @@ namespace persistent {
       static bool from (xml_parser_context& in, char& t) {
         if (in.next_token().empty()) {
           t = in.is.get();
+          if (t == '&') {
+            std::string entity;
+            std::getline(in.is, entity, ';');
+            entity = '&' + entity + ';';
+            xml::unescape(entity);
+            t = entity.empty() ? 0 : entity.front();
+          }
           return true;
         }
         return false;
       }
     };
 
+    // --------------------------------------------------------------------------
+    namespace xml {
+
+      /// convert element text or attribute value
+      template<typename T>
+      bool read_text (std::string_view text, T& t) {
+        if constexpr (std::is_arithmetic<T>::value) {
+          while (!text.empty() && ::isspace(static_cast<unsigned char>(text.front()))) {
+            text.remove_prefix(1);
+          }
+          typedef typename std::conditional<std::is_same<T, bool>::value, int, T>::type value_type;
+          value_type v = {};
+          const auto r = std::from_chars(text.data(), text.data() + text.size(), v);
+          if (r.ec != std::errc()) {
+            throw std::runtime_error(msg_fmt() << "Could not convert '" << text << "' to " << typeid(T).name());
+          }
+          t = static_cast<T>(v);
+          return true;
+        } else {
+          imemstream is(text.data(), text.size());
+          return read_value(is, t);
+        }
+      }
+
+      inline bool read_text (std::string_view text, std::string& t) {
+        if (text.find('&') == std::string_view::npos) {
+          t.assign(text);
+        } else {
+          t.resize(text.size());
+          char* data = t.data();
+          t.resize(unescape(text.data(), text.data() + text.size(), data) - data);
+        }
+        return true;
+      }
+
+      inline bool read_text (std::string_view text, char& t) {
+        char buffer[16];
+        if (!text.empty() && (text.front() == '&') && (text.size() <= sizeof(buffer))) {
+          t = (unescape(text.data(), text.data() + text.size(), buffer) != buffer) ? buffer[0] : 0;
+        } else {
+          t = text.empty() ? 0 : text.front();
+        }
+        return true;
+      }
+
+      /// borrow the text or decode its entities to the scratch arena
+      inline bool read_text (std::string_view text, std::string_view& t, scratch_arena* scratch) {
+        if (!scratch) {
+          throw std::runtime_error("std::string_view can only be read borrowed from contiguous memory");
+        }
+        if (text.find('&') == std::string_view::npos) {
+          t = text;
+        } else {
+          char* data = scratch->allocate(text.size());
+          t = std::string_view(data, unescape(text.data(), text.data() + text.size(), data) - data);
+        }
+        return true;
+      }
+
+    } // namespace xml
+
     template<typename T>
-    bool read_xml (std::istream& is, T& t) {
-      xml_parser_context in(is);
+    struct read_value_t<xml_buffer_context, T> {
+      static bool from (xml_buffer_context& in, T& t) {
+        if (in.next_token().empty()) {
+          return xml::read_text(in.text(), t);
+        }
+        return false;
+      }
+    };
+
+    template<>
+    struct read_value_t<xml_buffer_context, std::string_view> {
+      static bool from (xml_buffer_context& in, std::string_view& t) {
+        if (in.next_token().empty()) {
+          return xml::read_text(in.text(), t, in.scratch);
+        }
+        return false;
+      }
+    };
+
+    // --------------------------------------------------------------------------
+    //
+    // xml parser for attribute mode over contiguous input.
+    // The attributes of a start tag are read as the first members of the element,
+    // self-closing elements have no content and no end tag.
+    //
+    struct xml_attribute_parser_context : public xml_buffer_context {
+      xml_attribute_parser_context (const char* begin, const char* end)
+        : xml_buffer_context(begin, end)
+      {}
+
+      explicit xml_attribute_parser_context (std::string_view data)
+        : xml_buffer_context(data)
+      {}
+
+      /// consume the next start tag, remember its attributes and return its name.
+      std::string_view start_element () {
+        std::string_view tag = next_token();
+        if (!xml::is_start_tag(tag)) {
+          throw std::runtime_error(msg_fmt() << "Expected '<xyz>' but got '" << tag << "'");
+        }
+        clear_token();
+        empty = (tag[tag.size() - 2] == '/');
+        tag = tag.substr(1, tag.size() - (empty ? 3 : 2));
+        const auto n = tag.find_first_of(" \t\r\n");
+        if (n == std::string_view::npos) {
+          attrs = {};
+          return tag;
+        }
+        attrs = tag.substr(n);
+        return tag.substr(0, n);
+      }
+
+      /// the next attribute of the current start tag, its value becomes the content.
+      bool next_attribute (std::string_view& name) {
+        skip_ws(attrs);
+        if (attrs.empty()) {
+          return false;
+        }
+        const auto eq = attrs.find('=');
+        if (eq == std::string_view::npos) {
+          throw std::runtime_error(msg_fmt() << "Expected '=' in attributes '" << attrs << "'");
+        }
+        name = attrs.substr(0, eq);
+        while (!name.empty() && ::isspace(static_cast<unsigned char>(name.back()))) {
+          name.remove_suffix(1);
+        }
+        attrs.remove_prefix(eq + 1);
+        skip_ws(attrs);
+        const auto end = attrs.empty() ? std::string_view::npos : attrs.find(attrs.front(), 1);
+        if ((end == std::string_view::npos) || ((attrs.front() != '"') && (attrs.front() != '\''))) {
+          throw std::runtime_error(msg_fmt() << "Expected quoted value for attribute '" << name << "'");
+        }
+        value = attrs.substr(1, end - 1);
+        attrs.remove_prefix(end + 1);
+        attribute = has_value = true;
+        return true;
+      }
+
+      /// the start tag has no more attributes.
+      bool attributes_empty () {
+        skip_ws(attrs);
+        return attrs.empty();
+      }
+
+      /// the text of the current attribute or element, false if an element follows.
+      bool content (std::string_view& t) {
+        if (has_value) {
+          t = value;
+          has_value = false;
+          return true;
+        }
+        if (empty) {
+          t = {};
+          return true;
+        }
+        if (!next_token().empty()) {
+          return false;
+        }
+        t = text();
+        return true;
+      }
+
+      /// finish the current attribute or element.
+      void end_element (std::string_view name) {
+        if (attribute) {
+          attribute = has_value = false;
+          return;
+        }
+        attrs = {};
+        if (empty) {
+          empty = false;
+        } else {
+          check_end_tag(name);
+        }
+      }
+
+      /// skip the value of the current attribute or the content of the current element.
+      void skip_content () {
+        if (attribute) {
+          has_value = false;
+        } else {
+          attrs = {};
+          if (!empty) {
+            skip_element();
+          }
+        }
+      }
+
+      std::string_view attrs;   /// unread attributes of the current start tag
+      std::string_view value;   /// value of the current attribute
+      bool has_value = false;   /// value is not read yet
+      bool attribute = false;   /// the current member is an attribute
+      bool empty = false;       /// the current element is self-closing
+
+    private:
+      static void skip_ws (std::string_view& s) {
+        while (!s.empty() && ::isspace(static_cast<unsigned char>(s.front()))) {
+          s.remove_prefix(1);
+        }
+      }
+    };
+
+    template<>
+    struct table_driven<xml_attribute_parser_context> : std::true_type {};
+
+    template<>
+    struct parser<xml_attribute_parser_context> {
+
+      static bool read_list_start (xml_attribute_parser_context& in) {
+        return !in.attribute;
+      }
+
+      static bool read_list_element_init (xml_attribute_parser_context& in, int) {
+        if (in.empty) {
+          return false;
+        }
+        const std::string_view token = in.next_token();
+        if (in.good() && xml::is_start_tag(token) && (token.compare(1, 2, "li") == 0) &&
+            ((token.size() == 4) || ::isspace(static_cast<unsigned char>(token[3])) || (token[3] == '/'))) {
+          in.start_element();
+          return true;
+        }
+        return false;
+      }
+
+      static void read_list_element_finish (xml_attribute_parser_context& in) {
+        in.end_element(xml::s_li_name);
+      }
+
+      static void read_list_end (xml_attribute_parser_context&) {
+      }
+
+      static void read_property_init (xml_attribute_parser_context& in, std::string& key) {
+        key.assign(in.start_element());
+      }
+
+      static void read_property_finish (xml_attribute_parser_context& in, const std::string& key) {
+        in.end_element(key);
+      }
+
+      static bool read_next_struct_element (xml_attribute_parser_context& in, std::string& key) {
+        std::string_view name;
+        if (in.next_attribute(name)) {
+          key.assign(name);
+          return true;
+        }
+        if (in.empty) {
+          return false;
+        }
+        const std::string_view token = in.next_token();
+        if (in.good() && xml::is_start_tag(token)) {
+          key.assign(in.start_element());
+          return true;
+        }
+        return false;
+      }
+
+      static void read_struct_element_finish (xml_attribute_parser_context& in, const std::string& key) {
+        in.end_element(key);
+      }
+
+      static bool is_ptr_empty (xml_attribute_parser_context& in) {
+        if (in.has_value) {
+          return false;
+        }
+        if (in.empty) {
+          return in.attributes_empty();
+        }
+        const std::string_view token = in.next_token();
+        return in.good() && xml::is_end_tag(token);
+      }
+
+      static void skip_value (xml_attribute_parser_context& in) {
+        in.skip_content();
+      }
+    };
+
+    template<typename T>
+    struct read_value_t<xml_attribute_parser_context, T> {
+      static bool from (xml_attribute_parser_context& in, T& t) {
+        std::string_view text;
+        return in.content(text) && xml::read_text(text, t);
+      }
+    };
+
+    template<>
+    struct read_value_t<xml_attribute_parser_context, std::string_view> {
+      static bool from (xml_attribute_parser_context& in, std::string_view& t) {
+        std::string_view text;
+        return in.content(text) && xml::read_text(text, t, in.scratch);
+      }
+    };
+
+    // --------------------------------------------------------------------------
+    template<typename Context, typename T>
+    bool read_xml_context (Context& in, T& t) {
       in.check_token(xml::s_header);
       in.check_token(xml::s_body);
       const bool found = read(in, t);
@@ -274,6 +1128,60 @@ namespace persistent {
       return found;
     }
 
+    template<typename T>
+    bool read_xml_buffer (std::string_view data, T& t, bool attributes, scratch_arena* scratch) {
+      if (attributes) {
+        xml_attribute_parser_context in(data);
+        in.scratch = scratch;
+        in.check_token(xml::s_header);
+        if (in.start_element() != xml::s_body_name) {
+          throw std::runtime_error(msg_fmt() << "Expected '" << xml::s_body << "'");
+        }
+        const bool found = read(in, t);
+        in.end_element(xml::s_body_name);
+        return found;
+      }
+      xml_buffer_context in(data);
+      in.scratch = scratch;
+      return read_xml_context(in, t);
+    }
+
+    /// read xml from contiguous memory, e.g. a string or a mapped file.
+    template<typename T>
+    bool read_xml (std::string_view data, T& t, bool attributes = false) {
+      return read_xml_buffer(data, t, attributes, nullptr);
+    }
+
+    /// borrowed read, std::string_view members point into data or into the scratch arena.
+    template<typename T>
+    bool read_xml (std::string_view data, T& t, scratch_arena& scratch, bool attributes = false) {
+      return read_xml_buffer(data, t, attributes, &scratch);
+    }
+
+    /// read with the strings, containers and pointees created by the read allocated from resource.
+    template<typename T>
+    bool read_xml (std::string_view data, T& t, std::pmr::memory_resource* resource, bool attributes = false) {
+      memory_scope scope(resource);
+      return read_xml_buffer(data, t, attributes, nullptr);
+    }
+
+    /// attribute mode reads the whole stream into memory first.
+    template<typename T>
+    bool read_xml (std::istream& is, T& t, bool attributes = false) {
+      if (attributes) {
+        const std::string data((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+        return read_xml(std::string_view(data), t, true);
+      }
+      xml_parser_context in(is);
+      return read_xml_context(in, t);
+    }
+
+    template<typename T>
+    bool read_xml (std::istream& is, T& t, std::pmr::memory_resource* resource, bool attributes = false) {
+      memory_scope scope(resource);
+      return read_xml(is, t, attributes);
+    }
+
   } // namespace io
 
 } // namespace persistent
@@ -0,0 +1,242 @@
+/**
+* @copyright (c) 2015-2021 Ing. Buero Rothfuss
+*                          Riedlinger Str. 8
+*                          70327 Stuttgart
+*                          Germany
+*                          http://www.rothfuss-web.de
+*
+* @author    <a href="mailto:armin@rothfuss-web.de">Armin Rothfuss</a>
+*
+* Project    persistent lib
+*
+* @brief     C++ struct persistence test
+*
+* @license   MIT license. See accompanying file LICENSE.
+*/
+
+#include <fstream>
+
+#include "persistent/persistent_dom.h"
+#include "persistent/persistent_json.h"
+#include <testing/testing.h>
+
+#include "test_structs.h"
+
+// --------------------------------------------------------------------------
+void test_write_1 () {
+  test2 t2;
+  t2.i1 = 815;
+  t2.t1.i = 4711;
+  dom::document doc;
+  io::write(doc.root(), t2);
+
+  dom::node& root = doc.root();
+  EXPECT_EQUAL(root.size(), 3);
+  EXPECT_EQUAL(root.children[0].key, "i1");
+  EXPECT_EQUAL(root.children[0].value, "815");
+  EXPECT_EQUAL(root.children[1].key, "t1");
+  EXPECT_EQUAL(root.children[1].size(), 2);
+  EXPECT_EQUAL(root.find("t1")->find("i")->value, "4711");
+  EXPECT_TRUE(root.find("i2")->empty());
+  EXPECT_TRUE(root.find("k") == nullptr);
+}
+
+// --------------------------------------------------------------------------
+void test_write_list () {
+  test7 t7("Any Text", 4711);
+  dom::document doc;
+  io::write(doc.root(), t7);
+
+  dom::node* v = doc.root().find("v");
+  EXPECT_TRUE(v != nullptr);
+  EXPECT_EQUAL(v->size(), 2);
+  EXPECT_EQUAL(v->children[0].value, "Any Text");
+  EXPECT_EQUAL(v->children[1].value, "4711");
+
+  std::map<std::string, double> m { { "one", 1 }, { "two", 2.5 } };
+  dom::document doc2;
+  io::write(doc2.root(), m);
+  EXPECT_EQUAL(doc2.root().size(), 2);
+  EXPECT_EQUAL(doc2.root().find("two")->value, "2.5");
+}
+
+// --------------------------------------------------------------------------
+void test_read_1 () {
+  dom::document doc;
+  dom::node& t1 = doc.root().add("t1");
+  t1.add("k").value = "unknown";
+  t1.add("j").value = "203";
+  t1.add("i").value = "911";
+  doc.root().add("i1").value = "815";
+  doc.root().add("i2").value = "4711";
+
+  test2 t2;
+  EXPECT_TRUE(io::read(doc.root(), t2));
+  EXPECT_EQUAL(t2.i1, 815);
+  EXPECT_EQUAL(t2.t1.i, 911);
+  EXPECT_EQUAL(t2.t1.j, 203);
+  EXPECT_EQUAL(*(t2.i2), 4711);
+}
+
+// --------------------------------------------------------------------------
+void test_read_into () {
+  dom::document doc;
+  doc.root().add("t1").add("i").value = "911";
+  doc.root().add("i1").value = "815";
+
+  test2 t2;
+  t2.t1.j = 203;
+  t2.i2 = std::make_unique<int64_t>(4711);
+  io::read_into_scope into;
+  EXPECT_TRUE(io::read(doc.root(), t2));
+  EXPECT_EQUAL(t2.i1, 815);
+  EXPECT_EQUAL(t2.t1.i, 911);
+  EXPECT_EQUAL(t2.t1.j, 0);
+  EXPECT_FALSE(t2.i2);
+}
+
+// --------------------------------------------------------------------------
+void test_read_vector () {
+  dom::document doc;
+  io::write(doc.root(), std::vector<int>{ 1, 2 });
+
+  // without a scope, the elements are appended
+  std::vector<int> v = { 7, 8, 9 };
+  EXPECT_TRUE(io::read(doc.root(), v));
+  EXPECT_EQUAL(v, std::vector<int>({ 7, 8, 9, 1, 2 }));
+
+  // in a scope, the elements are overwritten and the rest is removed
+  io::read_into_scope into;
+  EXPECT_TRUE(io::read(doc.root(), v));
+  EXPECT_EQUAL(v, std::vector<int>({ 1, 2 }));
+}
+
+// --------------------------------------------------------------------------
+void test_round_trip () {
+  MpStat s;
+  std::ifstream is("test.json");
+  io::read_json(is, s);
+
+  dom::document doc;
+  io::write(doc.root(), s);
+
+  MpStat s2;
+  EXPECT_TRUE(io::read(doc.root(), s2));
+
+  std::ostringstream os1;
+  io::write_json(os1, s);
+  std::ostringstream os2;
+  io::write_json(os2, s2);
+  EXPECT_EQUAL(os1.str(), os2.str());
+
+  doc.clear();
+  EXPECT_TRUE(doc.root().empty());
+
+  std::pair<std::string, int> p("x", 1);
+  auto t = std::make_tuple(1, std::string("two"), 3.5);
+  io::write(doc.root().add("p"), p);
+  io::write(doc.root().add("t"), t);
+
+  std::pair<std::string, int> p2;
+  std::tuple<int, std::string, double> t2;
+  io::read(*doc.root().find("p"), p2);
+  io::read(*doc.root().find("t"), t2);
+  EXPECT_EQUAL(p2.first, "x");
+  EXPECT_EQUAL(p2.second, 1);
+  EXPECT_TRUE(t2 == t);
+}
+
+// --------------------------------------------------------------------------
+void test_containers () {
+  std::unordered_map<int, std::string> um { { 1, "one" }, { 2, "two" } };
+  persistent::flat_map<std::string, int> fm { { "b", 2 }, { "a", 1 } };
+  std::set<int> s { 3, 1, 2 };
+  dom::document doc;
+  io::write(doc.root().add("um"), um);
+  io::write(doc.root().add("fm"), fm);
+  io::write(doc.root().add("s"), s);
+
+  std::unordered_map<int, std::string> um2;
+  persistent::flat_map<std::string, int> fm2;
+  std::set<int> s2;
+  io::read(*doc.root().find("um"), um2);
+  io::read(*doc.root().find("fm"), fm2);
+  io::read(*doc.root().find("s"), s2);
+  EXPECT_TRUE(um2 == um);
+  EXPECT_TRUE(fm2 == fm);
+  EXPECT_EQUAL(s2, s);
+
+  test8 t8;
+  t8.v = std::string("abc");
+  io::write(doc.root().add("t8"), t8);
+  test8 t8b;
+  t8b.o = 9;
+  io::read(*doc.root().find("t8"), t8b);
+  EXPECT_FALSE(t8b.o.has_value());
+  EXPECT_EQUAL(std::get<std::string>(t8b.v), "abc");
+
+  test9 t9;
+  auto c = std::make_shared<circle>();
+  c->r = 3;
+  t9.s = c;
+  t9.l = { std::make_shared<label>(), nullptr };
+  io::write(doc.root().add("t9"), t9);
+  test9 t9b;
+  io::read(*doc.root().find("t9"), t9b);
+  EXPECT_EQUAL(typeid(*t9b.s), typeid(circle));
+  EXPECT_EQUAL(static_cast<circle&>(*t9b.s).r, 3);
+  EXPECT_EQUAL(t9b.l.size(), 2);
+  EXPECT_EQUAL(typeid(*t9b.l[0]), typeid(label));
+  EXPECT_FALSE(t9b.l[1]);
+
+  test10 t10;
+  t10.s1 = t10.s2 = c;
+  t10.v = { std::make_shared<test_int64>(), nullptr };
+  t10.v[1] = t10.v[0];
+  io::shared_scope scope;
+  io::write(doc.root().add("t10"), t10);
+  test10 t10b;
+  io::read(*doc.root().find("t10"), t10b);
+  EXPECT_EQUAL(typeid(*t10b.s1), typeid(circle));
+  EXPECT_EQUAL(t10b.s1, t10b.s2);
+  EXPECT_EQUAL(t10b.v.size(), 2);
+  EXPECT_EQUAL(t10b.v[0], t10b.v[1]);
+}
+
+// --------------------------------------------------------------------------
+struct dom_test : public dom_struct<dom_test> {
+  int i = 0;
+  std::vector<std::string> v;
+
+  auto attributes () {
+    return make_attributes(attribute(i, "i"), attribute(v, "v"));
+  }
+};
+
+void test_dom_struct () {
+  dom_test t;
+  t.i = 42;
+  t.v = { "a", "b" };
+  dom::document doc;
+  t.write(doc.root());
+
+  dom_test t2;
+  EXPECT_TRUE(t2.read(doc.root()));
+  EXPECT_EQUAL(t2.i, 42);
+  EXPECT_EQUAL(t2.v, t.v);
+}
+
+// --------------------------------------------------------------------------
+void test_main (const testing::start_params& params) {
+  testing::log_info("Running " __FILE__);
+  run_test(test_write_1);
+  run_test(test_write_list);
+  run_test(test_read_1);
+  run_test(test_read_into);
+  run_test(test_read_vector);
+  run_test(test_round_trip);
+  run_test(test_containers);
+  run_test(test_dom_struct);
+}
+
+// --------------------------------------------------------------------------
@@ -296,6 +296,79 @@ void test_read4 () {
   EXPECT_EQUAL(s.get_integer(), 4711);
 }
 
+// --------------------------------------------------------------------------
+struct MyStruct5 {
+
+  const std::vector<std::string>& get_list () const {
+    return l;
+  }
+
+  int get_integer () const {
+    return i;
+  }
+
+  void set_list (std::vector<std::string> l_) {
+    l = std::move(l_);
+  }
+
+  // setters may be noexcept
+  void set_integer (int i_) noexcept {
+    i = i_;
+  }
+
+private:
+  std::vector<std::string> l;
+  int i = 0;
+
+};
+
+namespace persistent {
+
+  template <>
+  struct is_persistent<MyStruct5> : std::true_type {};
+
+  template<>
+  auto attributes (MyStruct5& t) {
+    return make_attributes(setter<&MyStruct5::set_list>(t, "l"), setter<&MyStruct5::set_integer>(t, "i"));
+  }
+
+  template<>
+  auto attributes (const MyStruct5& t) {
+    return make_attributes(getter<&MyStruct5::get_list>(t, "l"), getter<&MyStruct5::get_integer>(t, "i"));
+  }
+
+}
+
+// --------------------------------------------------------------------------
+void test_write5 () {
+
+  MyStruct5 s;
+  s.set_list({ "a", "b" });
+  s.set_integer(4711);
+
+  // the list is referenced, not copied
+  const auto attr = persistent::attributes(static_cast<const MyStruct5&>(s));
+  EXPECT_EQUAL(&persistent::get_property_value(std::get<0>(attr)), &s.get_list());
+
+  std::ostringstream os;
+  persistent::io::write_json(os, s, false);
+
+  EXPECT_EQUAL(os.str(), "{\"l\":[\"a\",\"b\"],\"i\":4711}");
+}
+
+// --------------------------------------------------------------------------
+void test_read5 () {
+
+  MyStruct5 s;
+
+  std::istringstream is("{\"l\":[\"a\",\"b\"],\"i\":4711}");
+  persistent::io::read_json(is, s);
+
+  const std::vector<std::string> expected({ "a", "b" });
+  EXPECT_EQUAL(s.get_list(), expected);
+  EXPECT_EQUAL(s.get_integer(), 4711);
+}
+
 // --------------------------------------------------------------------------
 void test_main (const testing::start_params& params) {
   testing::log_info("Running " __FILE__);
@@ -311,6 +384,9 @@ void test_main (const testing::start_params& params) {
 
   run_test(test_write4);
   run_test(test_read4);
+
+  run_test(test_write5);
+  run_test(test_read5);
 }
 
 // --------------------------------------------------------------------------
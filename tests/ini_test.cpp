@@ -14,6 +14,9 @@
 * @license   MIT license. See accompanying file LICENSE.
 */
 
+#include <fstream>
+#include <cstdio>
+
 #include "persistent/persistent_ini.h"
 #include <testing/testing.h>
 
@@ -110,6 +113,40 @@ void test_read_pair () {
   EXPECT_FALSE(is.good());
 }
 // --------------------------------------------------------------------------
+void test_read_optional () {
+  test8 t;
+  t.o = 9;
+  std::istringstream is("i=\n"
+                        "v.0=2\n"
+                        "v.1.i=3\n"
+                        "v.1.j=4\n");
+  io::read_ini(is, t);
+  EXPECT_FALSE(t.o.has_value());
+  EXPECT_EQUAL(std::get<test_int64>(t.v).i, 3);
+  EXPECT_EQUAL(std::get<test_int64>(t.v).j, 4);
+
+  test9 t9;
+  std::istringstream is2("i.0=1\n"
+                         "i.1.i=2\n"
+                         "i.1.j=3\n");
+  io::read_ini(is2, t9);
+  EXPECT_EQUAL(typeid(*t9.s), typeid(circle));
+  EXPECT_EQUAL(t9.s->i, 2);
+  EXPECT_EQUAL(static_cast<circle&>(*t9.s).r, 3);
+
+  test10 t10;
+  std::istringstream is3("v.0.0=0\n"
+                         "v.0.1.i=4\n"
+                         "v.0.1.j=5\n"
+                         "v.1.0=0\n"
+                         "v.1.1=\n");
+  io::shared_scope scope;
+  io::read_ini(is3, t10);
+  EXPECT_EQUAL(t10.v.size(), 2);
+  EXPECT_EQUAL(t10.v[0], t10.v[1]);
+  EXPECT_EQUAL(t10.v[1]->j, 5);
+}
+// --------------------------------------------------------------------------
 void test_read_map () {
   std::istringstream is("one=1\n"
                         "three=3\n"
@@ -120,6 +157,49 @@ void test_read_map () {
   EXPECT_EQUAL(m, expected);
 }
 
+// --------------------------------------------------------------------------
+void test_read_pmr () {
+  std::pmr::monotonic_buffer_resource resource;
+  test12 t;
+  std::istringstream is("i=a string longer than the small buffer\n"
+                        "v.0=another string longer than the small buffer\n"
+                        "j.1=one\n");
+  io::read_ini(is, t, &resource);
+  EXPECT_EQUAL(t.s, "a string longer than the small buffer");
+  EXPECT_TRUE(t.s.get_allocator().resource() == &resource);
+  EXPECT_TRUE(t.v.get_allocator().resource() == &resource);
+  EXPECT_EQUAL(t.v.size(), 1);
+  EXPECT_TRUE(t.v[0].get_allocator().resource() == &resource);
+  EXPECT_TRUE(t.m.get_allocator().resource() == &resource);
+  EXPECT_EQUAL(t.m[1], "one");
+
+  std::pmr::map<std::pmr::string, int> m;
+  std::istringstream is2("a key longer than the small buffer=1\n"
+                         "b=2\n");
+  io::read_ini(is2, m, &resource);
+  EXPECT_EQUAL(m.size(), 2);
+  EXPECT_EQUAL(m.begin()->first, "a key longer than the small buffer");
+  EXPECT_TRUE(m.begin()->first.get_allocator().resource() == &resource);
+}
+// --------------------------------------------------------------------------
+void test_read_containers () {
+  std::istringstream is1("one=1\n"
+                         "three=3\n"
+                         "two=2\n");
+  persistent::flat_map<std::string, double> fm;
+  io::read_ini(is1, fm);
+  persistent::flat_map<std::string, double> expected_fm { { "one", 1 }, { "two", 2 }, { "three", 3 } };
+  EXPECT_TRUE(fm == expected_fm);
+
+  std::istringstream is2("0=3\n"
+                         "1=1\n"
+                         "2=2\n");
+  std::set<int> s;
+  io::read_ini(is2, s);
+  std::set<int> expected_s { 1, 2, 3 };
+  EXPECT_EQUAL(s, expected_s);
+}
+
 // --------------------------------------------------------------------------
 void test_read_1 () {
 
@@ -310,6 +390,100 @@ void test_read_11 () {
   EXPECT_FALSE(is.good());
 }
 
+// --------------------------------------------------------------------------
+void test_read_12 () {
+  MpStat s;
+  std::istringstream is("sysstat.hosts.0.nodename=host\n"
+                        "sysstat.hosts.0.number-of-cpus=12\n"
+                        "sysstat.hosts.0.statistics.0.timestamp=10:00\n"
+                        "sysstat.hosts.0.statistics.0.cpu-load.0.cpu=all\n"
+                        "sysstat.hosts.0.statistics.0.cpu-load.0.usr=7.55\n"
+                        "sysstat.hosts.0.statistics.0.cpu-load.12.cpu=11\n"
+                        "sysstat.hosts.0.statistics.0.cpu-load.12.sys=2.5\n"
+                        "sysstat.hosts.1.nodename=other\n");
+  io::read_ini(is, s);
+
+  EXPECT_EQUAL(s.sysstat.hosts.size(), 2);
+  EXPECT_EQUAL(s.sysstat.hosts[0].nodename, "host");
+  EXPECT_EQUAL(s.sysstat.hosts[0].number_of_cpus, 12);
+  EXPECT_EQUAL(s.sysstat.hosts[0].statistics.size(), 1);
+  EXPECT_EQUAL(s.sysstat.hosts[0].statistics[0].timestamp, "10:00");
+  EXPECT_EQUAL(s.sysstat.hosts[0].statistics[0].cpu_load.size(), 13);
+  EXPECT_EQUAL(s.sysstat.hosts[0].statistics[0].cpu_load[0].cpu, "all");
+  EXPECT_EQUAL(s.sysstat.hosts[0].statistics[0].cpu_load[0].usr, 7.55F);
+  EXPECT_EQUAL(s.sysstat.hosts[0].statistics[0].cpu_load[12].cpu, "11");
+  EXPECT_EQUAL(s.sysstat.hosts[0].statistics[0].cpu_load[12].sys, 2.5F);
+  EXPECT_EQUAL(s.sysstat.hosts[1].nodename, "other");
+}
+
+// --------------------------------------------------------------------------
+void test_read_sections () {
+  MpStat s;
+  std::istringstream is("[sysstat.hosts.0]\n"
+                        "nodename=host\n"
+                        "; a comment\n"
+                        "number-of-cpus=12\n"
+                        "[sysstat.hosts.0.statistics.0.cpu-load]\n"
+                        "0.cpu=all\n"
+                        "12.cpu=11\n"
+                        "[ sysstat.hosts.0.statistics.0.cpu-load.3 ]\n"
+                        "usr=7.5\n"
+                        "[]\n"
+                        "sysstat.hosts.1.nodename=other\n");
+  io::read_ini(is, s);
+
+  EXPECT_EQUAL(s.sysstat.hosts.size(), 2);
+  EXPECT_EQUAL(s.sysstat.hosts[0].nodename, "host");
+  EXPECT_EQUAL(s.sysstat.hosts[0].number_of_cpus, 12);
+  EXPECT_EQUAL(s.sysstat.hosts[0].statistics[0].cpu_load.size(), 13);
+  EXPECT_EQUAL(s.sysstat.hosts[0].statistics[0].cpu_load[0].cpu, "all");
+  EXPECT_EQUAL(s.sysstat.hosts[0].statistics[0].cpu_load[3].usr, 7.5F);
+  EXPECT_EQUAL(s.sysstat.hosts[0].statistics[0].cpu_load[12].cpu, "11");
+  EXPECT_EQUAL(s.sysstat.hosts[1].nodename, "other");
+
+  std::ostringstream os;
+  io::write_ini(os, s, true);
+  MpStat s2;
+  std::istringstream is2(os.str());
+  io::read_ini(is2, s2);
+
+  std::ostringstream os2;
+  io::write_ini(os2, s2);
+  std::ostringstream os3;
+  io::write_ini(os3, s);
+  EXPECT_EQUAL(os2.str(), os3.str());
+}
+
+// --------------------------------------------------------------------------
+void test_path () {
+  io::ini_path key;
+  std::istringstream is("  t1.v .3.i =4711\n");
+  key.read_key(is);
+
+  EXPECT_EQUAL(key.size(), 4);
+  EXPECT_EQUAL(key.element(0), "t1");
+  EXPECT_EQUAL(key.element(1), "v");
+  EXPECT_EQUAL(key.element(2), "3");
+  EXPECT_EQUAL(key.element(3), "i");
+
+  io::ini_path path;
+  path.push("t1");
+  path.push("v");
+  EXPECT_TRUE(path.is_parent_of(key));
+  path.push(3);
+  path.push("i");
+  EXPECT_FALSE(path.is_parent_of(key));
+  EXPECT_TRUE(path.match(key));
+  path.pop();
+  path.pop();
+  path.push("j");
+  EXPECT_FALSE(path.is_parent_of(key));
+
+  std::ostringstream os;
+  path.print(os);
+  EXPECT_EQUAL(os.str(), "t1.v.j");
+}
+
 // --------------------------------------------------------------------------
 void test_write_1 () {
   int64_t i = 4711;
@@ -341,6 +515,21 @@ void test_write_3 () {
                          "i2=\n");
 }
 
+// --------------------------------------------------------------------------
+void test_write_sections () {
+  test2 t2;
+  t2.t1.i = 4711;
+  std::ostringstream os;
+  io::write_ini(os, t2, true);
+
+  EXPECT_EQUAL(os.str(), "i1=0\n"
+                         "[t1]\n"
+                         "i=4711\n"
+                         "j=0\n"
+                         "[]\n"
+                         "i2=\n");
+}
+
 // --------------------------------------------------------------------------
 void test_write_4 () {
   test3 t3;
@@ -431,6 +620,155 @@ void test_write_map () {
                          "two=2\n");
 }
 
+void test_read_parallel () {
+  MpStat s;
+  s.sysstat.hosts.resize(3);
+  for (std::size_t h = 0; h < s.sysstat.hosts.size(); ++h) {
+    Host& host = s.sysstat.hosts[h];
+    host.nodename = "host" + std::to_string(h);
+    host.number_of_cpus = static_cast<int>(h + 1);
+    host.statistics.resize(2);
+    for (Statistics& st : host.statistics) {
+      st.cpu_load.resize(600);
+      for (std::size_t i = 0; i < st.cpu_load.size(); ++i) {
+        st.cpu_load[i] = { std::to_string(i), i * 0.5F, 0, 1, 2, 3, 4, 5, 6, 7, 8 };
+      }
+    }
+  }
+
+  const std::string filename = "read_parallel_test.ini";
+  {
+    std::ofstream os(filename);
+    os << "# large file\n";
+    io::write_ini(os, s, true);
+    os << "[sysstat.hosts.0]\n"
+          "nodename=last\n"
+          "unknown=1\n";
+  }
+
+  MpStat s1;
+  {
+    std::ifstream is(filename);
+    io::read_ini(is, s1, filename);
+  }
+  MpStat s2;
+  EXPECT_TRUE(io::read_ini_parallel(filename, s2, 4));
+  std::remove(filename.c_str());
+
+  EXPECT_EQUAL(s2.sysstat.hosts.size(), 3);
+  EXPECT_EQUAL(s2.sysstat.hosts[0].nodename, "last");
+  EXPECT_EQUAL(s2.sysstat.hosts[2].statistics[1].cpu_load[599].usr, 299.5F);
+
+  std::ostringstream os1;
+  io::write_ini(os1, s1);
+  std::ostringstream os2;
+  io::write_ini(os2, s2);
+  EXPECT_EQUAL(os1.str(), os2.str());
+}
+
+// --------------------------------------------------------------------------
+struct test_wide : private persistent_struct {
+  static std::size_t attributes_calls;
+
+  int64_t a0 = 0;
+  int64_t a1 = 0;
+  int64_t a2 = 0;
+  int64_t a3 = 0;
+  int64_t a4 = 0;
+  int64_t a5 = 0;
+  int64_t a6 = 0;
+  int64_t a7 = 0;
+  int64_t a8 = 0;
+  int64_t a9 = 0;
+  int64_t a10 = 0;
+  int64_t a11 = 0;
+  int64_t a12 = 0;
+  int64_t a13 = 0;
+  int64_t a14 = 0;
+  int64_t a15 = 0;
+  int64_t a16 = 0;
+  int64_t a17 = 0;
+  int64_t a18 = 0;
+  int64_t a19 = 0;
+  int64_t a20 = 0;
+  int64_t a21 = 0;
+  int64_t a22 = 0;
+  int64_t a23 = 0;
+
+  auto attributes () {
+    ++attributes_calls;
+    return make_attributes(attribute(a0, "a0"),
+                           attribute(a1, "a1"),
+                           attribute(a2, "a2"),
+                           attribute(a3, "a3"),
+                           attribute(a4, "a4"),
+                           attribute(a5, "a5"),
+                           attribute(a6, "a6"),
+                           attribute(a7, "a7"),
+                           attribute(a8, "a8"),
+                           attribute(a9, "a9"),
+                           attribute(a10, "a10"),
+                           attribute(a11, "a11"),
+                           attribute(a12, "a12"),
+                           attribute(a13, "a13"),
+                           attribute(a14, "a14"),
+                           attribute(a15, "a15"),
+                           attribute(a16, "a16"),
+                           attribute(a17, "a17"),
+                           attribute(a18, "a18"),
+                           attribute(a19, "a19"),
+                           attribute(a20, "a20"),
+                           attribute(a21, "a21"),
+                           attribute(a22, "a22"),
+                           attribute(a23, "a23"));
+  }
+};
+
+std::size_t test_wide::attributes_calls = 0;
+
+// --------------------------------------------------------------------------
+void test_read_wide () {
+  std::ostringstream os;
+  for (int n = 0; n < 100; ++n) {
+    for (int i = 0; i < 24; ++i) {
+      os << "a" << i << "=" << (n * 24 + i) << "\n";
+    }
+  }
+
+  test_wide t;
+  const std::size_t calls = test_wide::attributes_calls;
+  std::istringstream is(os.str());
+  io::read_ini(is, t);
+
+  // the index is build once, the lines are dispatched without the attributes
+  EXPECT_TRUE(test_wide::attributes_calls - calls <= 1);
+  EXPECT_EQUAL(t.a0, 99 * 24);
+  EXPECT_EQUAL(t.a23, 99 * 24 + 23);
+}
+
+// --------------------------------------------------------------------------
+void test_read_wide_parallel () {
+  const std::string filename = "read_wide_test.ini";
+  {
+    std::ofstream os(filename);
+    for (int n = 0; n < 2000; ++n) {
+      for (int i = 0; i < 24; ++i) {
+        os << "a" << i << "=" << (n * 24 + i) << "\n";
+      }
+    }
+  }
+
+  test_wide t;
+  const std::size_t calls = test_wide::attributes_calls;
+  EXPECT_TRUE(io::read_ini_parallel(filename, t, 4));
+  std::remove(filename.c_str());
+
+  // the keys are resolved to the members on the workers, without the attributes
+  EXPECT_TRUE(test_wide::attributes_calls - calls <= 1);
+  EXPECT_EQUAL(t.a0, 1999 * 24);
+  EXPECT_EQUAL(t.a23, 1999 * 24 + 23);
+}
+
 // --------------------------------------------------------------------------
 void test_main (const testing::start_params& params) {
   testing::log_info("Running " __FILE__);
@@ -442,6 +780,7 @@ void test_main (const testing::start_params& params) {
   run_test(test_write_1);
   run_test(test_write_2);
   run_test(test_write_3);
+  run_test(test_write_sections);
   run_test(test_write_4);
   run_test(test_write_5);
   run_test(test_write_6);
@@ -453,7 +792,10 @@ void test_main (const testing::start_params& params) {
   run_test(test_read_array);
   run_test(test_read_vector);
   run_test(test_read_pair);
+  run_test(test_read_optional);
   run_test(test_read_map);
+  run_test(test_read_pmr);
+  run_test(test_read_containers);
   run_test(test_read_2);
   run_test(test_read_3);
   run_test(test_read_4);
@@ -465,6 +807,12 @@ void test_main (const testing::start_params& params) {
   run_test(test_read_9);
   run_test(test_read_10);
   run_test(test_read_11);
+  run_test(test_read_12);
+  run_test(test_read_sections);
+  run_test(test_path);
+  run_test(test_read_wide);
+  run_test(test_read_parallel);
+  run_test(test_read_wide_parallel);
 
 }
 
@@ -133,6 +133,60 @@ void test_read_map_3 () {
   std::map<key, double> expected { { key::first, 1.1 }, { key::second, 2.2 }, { key::third, 3.3 } };
   EXPECT_EQUAL(m, expected);
 }
+// --------------------------------------------------------------------------
+enum class numeric_key : int { one = 1, two = 2 };
+
+void test_read_map_4 () {
+  EXPECT_EQUAL(convert<int>::key_to_string(-42), "-42");
+  EXPECT_EQUAL(convert<int>::string_to_key("-42"), -42);
+  EXPECT_EQUAL(convert<double>::key_to_string(0.5), "0.5");
+  EXPECT_EQUAL(convert<double>::string_to_key("0.5"), 0.5);
+  EXPECT_EQUAL(convert<numeric_key>::key_to_string(numeric_key::two), "2");
+  EXPECT_TRUE(convert<numeric_key>::string_to_key("1") == numeric_key::one);
+
+  std::istringstream is("{3:3.3,1:1.1,2:2.2,4:4.4}");
+  std::map<int, double> m;
+  io::read_stream(is, m);
+  std::map<int, double> expected { { 1, 1.1 }, { 2, 2.2 }, { 3, 3.3 }, { 4, 4.4 } };
+  EXPECT_EQUAL(m, expected);
+
+  std::istringstream is2("{1x:1.1}");
+  try {
+    io::read_stream(is2, m);
+    EXPECT_TRUE(!"Exception expected");
+  } catch (std::exception&) {}
+}
+
+// --------------------------------------------------------------------------
+enum class named_key { one, two };
+
+std::ostream& operator<< (std::ostream& os, named_key k) {
+  return os << (k == named_key::one ? "one" : "two");
+}
+
+std::istream& operator>> (std::istream& is, named_key& k) {
+  std::string s;
+  is >> s;
+  k = (s == "one") ? named_key::one : named_key::two;
+  return is;
+}
+
+void test_read_map_5 () {
+  // enums with stream operators keep their own key format
+  EXPECT_EQUAL(convert<named_key>::key_to_string(named_key::two), "two");
+  EXPECT_TRUE(convert<named_key>::string_to_key("one") == named_key::one);
+
+  std::istringstream is("{one:1.1,two:2.2}");
+  std::map<named_key, double> m;
+  io::read_stream(is, m);
+  EXPECT_EQUAL(m.size(), 2);
+  EXPECT_EQUAL(m[named_key::one], 1.1);
+  EXPECT_EQUAL(m[named_key::two], 2.2);
+
+  std::ostringstream os;
+  io::write_stream(os, m);
+  EXPECT_EQUAL(os.str(), "{one:1.1,two:2.2}");
+}
 
 // --------------------------------------------------------------------------
 void test_read_1 () {
@@ -202,16 +256,23 @@ void test_read_6 () {
 
   test_int64 t1;
   std::istringstream is("{i:4711,k:815}");
-  try {
-    io::read_stream(is, t1);
-    EXPECT_FALSE("Exception expected");
-  } catch (std::exception& ex) {
-    EXPECT_TRUE("Exception expected");
-  }
+  io::read_stream(is, t1);
 
   EXPECT_EQUAL(t1.i, 4711);
   EXPECT_EQUAL(t1.j, 0);
-  EXPECT_TRUE(is.good());
+  EXPECT_TRUE(is.eof());
+}
+
+// --------------------------------------------------------------------------
+void test_read_skip () {
+
+  test_int64 t1;
+  std::istringstream is("{i:4711,k:{a:[1,{b:\"x,}]\"},[]],c:'y'},l:\"z\",j:815}");
+  io::read_stream(is, t1);
+
+  EXPECT_EQUAL(t1.i, 4711);
+  EXPECT_EQUAL(t1.j, 815);
+  EXPECT_TRUE(is.eof());
 }
 
 // --------------------------------------------------------------------------
@@ -406,12 +467,15 @@ void test_main (const testing::start_params& params) {
   run_test(test_read_map);
   run_test(test_read_map_2);
   run_test(test_read_map_3);
+  run_test(test_read_map_4);
+  run_test(test_read_map_5);
   run_test(test_read_1);
   run_test(test_read_2);
   run_test(test_read_3);
   run_test(test_read_4);
   run_test(test_read_5);
   run_test(test_read_6);
+  run_test(test_read_skip);
   run_test(test_read_7);
   run_test(test_read_8);
   run_test(test_read_9);
@@ -18,6 +18,11 @@
 #include <testing/testing.h>
 #include "test_structs.h"
 #include <fstream>
+#include <iterator>
+#include <thread>
+#ifndef WIN32
+# include <unistd.h>
+#endif
 
 // --------------------------------------------------------------------------
 void test_read_empty () {
@@ -91,6 +96,335 @@ void test_read_vector () {
   EXPECT_EQUAL(v, expected);
 }
 // --------------------------------------------------------------------------
+void test_read_vector_reserve () {
+  EXPECT_EQUAL(io::count_elements("", ""), 0);
+  const std::string empty = " ]";
+  EXPECT_EQUAL(io::count_elements(empty.data(), empty.data() + empty.size()), 0);
+  const std::string nested = "[1,2],{\"a\":1,\"b\":2},\"x,]\"],4";
+  EXPECT_EQUAL(io::count_elements(nested.data(), nested.data() + nested.size()), 3);
+  const std::string partial = "1,2,3";
+  EXPECT_EQUAL(io::count_elements(partial.data(), partial.data() + partial.size()), 3);
+
+  std::vector<std::vector<int>> v;
+  std::istringstream is("[[1,2,3],[4,5],[],[6,7,8,9,10,11,12,13,14,15,16,17,18,19,20,21,22]]");
+  io::read_json(is, v);
+  EXPECT_EQUAL(v.size(), 4);
+  EXPECT_EQUAL(v.capacity(), 4);
+  EXPECT_EQUAL(v[0].capacity(), 3);
+  EXPECT_EQUAL(v[2].size(), 0);
+  EXPECT_EQUAL(v[3].capacity(), 17);
+
+  std::vector<bool> b;
+  std::istringstream is2("[1,0,1]");
+  io::read_json(is2, b);
+  std::vector<bool> expected = {true, false, true};
+  EXPECT_EQUAL(b, expected);
+}
+// --------------------------------------------------------------------------
+void test_read_into () {
+  io::read_into_scope into;
+  std::vector<std::string> v = { "a rather long string that is on the heap", "b", "c", "d" };
+  const std::size_t capacity = v.capacity();
+  const std::size_t string_capacity = v[0].capacity();
+  const std::string* data = v.data();
+  std::istringstream is("[\"x\",\"y\"]");
+  io::read_json(is, v);
+  std::vector<std::string> expected = { "x", "y" };
+  EXPECT_EQUAL(v, expected);
+  EXPECT_EQUAL(v.capacity(), capacity);
+  EXPECT_EQUAL(v[0].capacity(), string_capacity);
+  EXPECT_TRUE(v.data() == data);
+
+  std::shared_ptr<int64_t> p = std::make_shared<int64_t>(1);
+  int64_t* pointee = p.get();
+  std::istringstream is2("4711");
+  io::read_json(is2, p);
+  EXPECT_TRUE(p.get() == pointee);
+  EXPECT_EQUAL(*p, 4711);
+}
+// --------------------------------------------------------------------------
+void test_read_into_stale () {
+  std::vector<test_int64> v(2);
+  v[0].i = 1;
+  v[0].j = 2;
+  v[1].i = 3;
+  std::map<std::string, int> m = { { "a", 1 } };
+  {
+    io::read_into_scope into;
+    std::istringstream is("[{\"i\":5}]");
+    io::read_json(is, v);
+    EXPECT_EQUAL(v.size(), 1);
+    EXPECT_EQUAL(v[0].i, 5);
+    EXPECT_EQUAL(v[0].j, 0);
+
+    std::istringstream is2("{\"b\":2}");
+    io::read_json(is2, m);
+    std::map<std::string, int> expected = { { "b", 2 } };
+    EXPECT_EQUAL(m, expected);
+  }
+
+  // without a scope, the elements are appended
+  std::istringstream is("[{\"j\":7}]");
+  io::read_json(is, v);
+  EXPECT_EQUAL(v.size(), 2);
+  EXPECT_EQUAL(v[0].i, 5);
+  EXPECT_EQUAL(v[1].i, 0);
+  EXPECT_EQUAL(v[1].j, 7);
+
+  std::istringstream is2("{\"c\":3}");
+  io::read_json(is2, m);
+  EXPECT_EQUAL(m.size(), 2);
+}
+
+// --------------------------------------------------------------------------
+void test_read_optional () {
+  test8 t;
+  t.o = 9;
+  std::istringstream is("{\"i\":null,\"v\":[2,{\"i\":3,\"j\":4}]}");
+  io::read_json(is, t);
+  EXPECT_FALSE(t.o.has_value());
+  EXPECT_EQUAL(t.v.index(), 2);
+  EXPECT_EQUAL(std::get<test_int64>(t.v).i, 3);
+  EXPECT_EQUAL(std::get<test_int64>(t.v).j, 4);
+
+  std::istringstream is2("{\"i\":5,\"v\":[1,\"abc\"]}");
+  io::read_json(is2, t);
+  EXPECT_EQUAL(t.o.value_or(0), 5);
+  EXPECT_EQUAL(std::get<std::string>(t.v), "abc");
+
+  std::istringstream is3("{\"v\":[3,1]}");
+  try {
+    io::read_json(is3, t);
+    EXPECT_TRUE(!"Exception expected");
+  } catch (std::exception&) {}
+}
+
+// --------------------------------------------------------------------------
+void test_read_variant_repeated () {
+  // alternatives of the same type are told apart by their index
+  std::variant<int, int> v;
+  std::istringstream is("[1,5]");
+  io::read_json(is, v);
+  EXPECT_EQUAL(v.index(), 1);
+  EXPECT_EQUAL(std::get<1>(v), 5);
+
+  std::ostringstream os;
+  io::write_json(os, v, false);
+  EXPECT_EQUAL(os.str(), "[1,5]");
+
+  std::istringstream is2("[0,3]");
+  io::read_json(is2, v);
+  EXPECT_EQUAL(v.index(), 0);
+  EXPECT_EQUAL(std::get<0>(v), 3);
+}
+// --------------------------------------------------------------------------
+void test_read_polymorphic () {
+  test9 t;
+  std::istringstream is("{\"i\":[1,{\"i\":2,\"j\":3}],\"v\":[[2,{\"i\":4,\"v\":\"abc\"}],null,[0,{\"i\":5}]]}");
+  io::read_json(is, t);
+  const circle* c = dynamic_cast<const circle*>(t.s.get());
+  EXPECT_TRUE(c != nullptr);
+  EXPECT_EQUAL(c->i, 2);
+  EXPECT_EQUAL(c->r, 3);
+  EXPECT_EQUAL(t.l.size(), 3);
+  const label* l = dynamic_cast<const label*>(t.l[0].get());
+  EXPECT_TRUE(l != nullptr);
+  EXPECT_EQUAL(l->i, 4);
+  EXPECT_EQUAL(l->text, "abc");
+  EXPECT_FALSE(t.l[1]);
+  EXPECT_EQUAL(typeid(*t.l[2]), typeid(shape));
+  EXPECT_EQUAL(t.l[2]->i, 5);
+
+  // an existing pointee of the same type is kept
+  const shape* p = t.s.get();
+  std::istringstream is2("{\"i\":[1,{\"j\":7}]}");
+  io::read_json(is2, t);
+  EXPECT_EQUAL(t.s.get(), p);
+  EXPECT_EQUAL(c->r, 7);
+
+  std::istringstream is3("{\"i\":[3,{}]}");
+  try {
+    io::read_json(is3, t);
+    EXPECT_TRUE(!"Exception expected");
+  } catch (std::exception&) {}
+}
+// --------------------------------------------------------------------------
+void test_read_shared () {
+  test10 t;
+  std::istringstream is("{\"i\":[0,[1,{\"i\":2,\"j\":3}]],\"j\":[0,null],"
+                        "\"v\":[[1,{\"i\":4,\"j\":5}],[1,null],null,[2,{\"i\":6,\"j\":7}]]}");
+  io::shared_scope scope;
+  io::read_json(is, t);
+  EXPECT_EQUAL(typeid(*t.s1), typeid(circle));
+  EXPECT_EQUAL(t.s1, t.s2);
+  EXPECT_EQUAL(t.v.size(), 4);
+  EXPECT_EQUAL(t.v[0], t.v[1]);
+  EXPECT_EQUAL(t.v[0]->j, 5);
+  EXPECT_FALSE(t.v[2]);
+  EXPECT_EQUAL(t.v[3]->i, 6);
+}
+// --------------------------------------------------------------------------
+void test_read_borrowed () {
+  const std::string data = "{\"i\":\"plain\",\"v\":[\"a\\\"b\\n\",\"\\u00e4\\ud83d\\ude00\",\"\"]}";
+  test11 t;
+  io::scratch_arena scratch;
+  io::read_json(data, t, scratch);
+  EXPECT_EQUAL(t.s, "plain");
+  EXPECT_TRUE((t.s.data() > data.data()) && (t.s.data() < data.data() + data.size()));
+  EXPECT_EQUAL(t.v.size(), 3);
+  EXPECT_EQUAL(t.v[0], "a\"b\n");
+  EXPECT_EQUAL(t.v[1], "\xc3\xa4\xf0\x9f\x98\x80");
+  EXPECT_EQUAL(t.v[2], "");
+
+  std::istringstream is(data);
+  try {
+    io::read_json(is, t);
+    EXPECT_TRUE(!"Exception expected");
+  } catch (std::exception&) {}
+}
+// --------------------------------------------------------------------------
+void test_read_escaped () {
+  const std::string data = "{\"i\":\"\\\"q\\\\\\\"\",\"v\":[\"a\\\"b\\n\",\"\\u00e4\\ud83d\\ude00\"]}";
+  test11 b;
+  io::scratch_arena scratch;
+  io::read_json(data, b, scratch);
+
+  std::string s;
+  std::istringstream is("\"\\\"q\\\\\\\"\"");
+  io::read_json(is, s);
+  EXPECT_EQUAL(s, "\"q\\\"");
+  EXPECT_EQUAL(s, b.s);
+
+  std::vector<std::string> v;
+  std::istringstream is2("[\"a\\\"b\\n\",\"\\u00e4\\ud83d\\ude00\"]");
+  io::read_json(is2, v);
+  EXPECT_EQUAL(v.size(), 2);
+  EXPECT_EQUAL(v[0], b.v[0]);
+  EXPECT_EQUAL(v[1], b.v[1]);
+
+  // both string types write the same escaped text, that reads back to the same value
+  std::ostringstream os1, os2;
+  io::write_json(os1, b, false);
+  io::write_json(os2, attribute(s, "i"), false);
+  EXPECT_EQUAL(os1.str(), "{\"i\":\"\\\"q\\\\\\\"\",\"v\":[\"a\\\"b\\n\",\"\xc3\xa4\xf0\x9f\x98\x80\"]}");
+  EXPECT_EQUAL(os2.str(), "\"i\":\"\\\"q\\\\\\\"\"");
+
+  const std::string written = os1.str();
+  test11 r;
+  io::read_json(written, r, scratch);
+  EXPECT_EQUAL(r.s, b.s);
+  EXPECT_EQUAL(r.v.size(), 2);
+  EXPECT_EQUAL(r.v[0], b.v[0]);
+  EXPECT_EQUAL(r.v[1], b.v[1]);
+
+  std::ostringstream os3;
+  io::write_json(os3, std::string("tab\t\x01"), false);
+  EXPECT_EQUAL(os3.str(), "\"tab\\t\\u0001\"");
+
+  // surrogates must come in pairs of a high and a low one
+  std::string pair;
+  std::istringstream isp("\"\\ud83d\\ude00\"");
+  io::read_json(isp, pair);
+  EXPECT_EQUAL(pair, "\xf0\x9f\x98\x80");
+  std::string_view pair_view;
+  const std::string pair_data = "\"\\ud83d\\ude00\"";
+  io::read_json(pair_data, pair_view, scratch);
+  EXPECT_EQUAL(pair_view, "\xf0\x9f\x98\x80");
+
+  for (const char* text : { "\"\\ud83d\"", "\"\\ude00\"", "\"\\ud83d\\u0041\"", "\"\\ud83dx\"" }) {
+    std::string u;
+    std::istringstream isu(text);
+    try {
+      io::read_json(isu, u);
+      EXPECT_TRUE(!"Exception expected");
+    } catch (std::exception&) {}
+
+    std::string_view uv;
+    const std::string data2 = text;
+    try {
+      io::read_json(data2, uv, scratch);
+      EXPECT_TRUE(!"Exception expected");
+    } catch (std::exception&) {}
+  }
+}
+// --------------------------------------------------------------------------
+struct counting_resource : public std::pmr::memory_resource {
+  std::size_t count = 0;
+
+  void* do_allocate (std::size_t n, std::size_t a) override {
+    ++count;
+    return std::pmr::new_delete_resource()->allocate(n, a);
+  }
+
+  void do_deallocate (void* p, std::size_t n, std::size_t a) override {
+    std::pmr::new_delete_resource()->deallocate(p, n, a);
+  }
+
+  bool do_is_equal (const std::pmr::memory_resource& rhs) const noexcept override {
+    return this == &rhs;
+  }
+};
+
+void test_read_pmr () {
+  counting_resource resource;
+  test12 t;
+  std::istringstream is("{\"i\":\"a string longer than the small buffer\","
+                        "\"v\":[\"another string longer than the small buffer\"],"
+                        "\"j\":{\"1\":\"one\"},\"i1\":{\"i\":3,\"j\":4}}");
+  io::read_json(is, t, &resource);
+  EXPECT_EQUAL(t.s, "a string longer than the small buffer");
+  EXPECT_TRUE(t.s.get_allocator().resource() == &resource);
+  EXPECT_TRUE(t.v.get_allocator().resource() == &resource);
+  EXPECT_EQUAL(t.v.size(), 1);
+  EXPECT_TRUE(t.v[0].get_allocator().resource() == &resource);
+  EXPECT_TRUE(t.m.get_allocator().resource() == &resource);
+  EXPECT_EQUAL(t.m[1], "one");
+  EXPECT_EQUAL(t.p->j, 4);
+  // string, vector, element, map node and the shared pointee
+  EXPECT_TRUE(resource.count >= 5);
+
+  std::ostringstream os;
+  io::write_json(os, t, false);
+  EXPECT_EQUAL(os.str(), "{\"i\":\"a string longer than the small buffer\","
+                         "\"v\":[\"another string longer than the small buffer\"],"
+                         "\"j\":{\"1\":\"one\"},\"i1\":{\"i\":3,\"j\":4}}");
+
+  // pmr string keys are taken as a whole
+  std::pmr::map<std::pmr::string, int> m;
+  std::istringstream is2("{\"a key longer than the small buffer\":1,\"b\":2}");
+  io::read_json(is2, m, &resource);
+  EXPECT_EQUAL(m.size(), 2);
+  EXPECT_TRUE(m.get_allocator().resource() == &resource);
+  EXPECT_EQUAL(m.begin()->first, "a key longer than the small buffer");
+  EXPECT_TRUE(m.begin()->first.get_allocator().resource() == &resource);
+  EXPECT_EQUAL(m.begin()->second, 1);
+
+  std::ostringstream os2;
+  io::write_json(os2, m, false);
+  EXPECT_EQUAL(os2.str(), "{\"a key longer than the small buffer\":1,\"b\":2}");
+}
+// --------------------------------------------------------------------------
+void test_read_into_allocations () {
+  // reading into the same values again allocates nothing after the first read
+  const std::string data = "{\"i\":\"a string longer than the small buffer\","
+                           "\"v\":[\"another string longer than the small buffer\",\"and a third long string\"]}";
+  counting_resource resource;
+  test12 t;
+  io::read_into_scope into;
+  std::istringstream is(data);
+  io::read_json(is, t, &resource);
+  const std::size_t warm = resource.count;
+  EXPECT_TRUE(warm > 0);
+  for (int n = 0; n < 3; ++n) {
+    std::istringstream is2(data);
+    io::read_json(is2, t, &resource);
+  }
+  EXPECT_EQUAL(resource.count, warm);
+  EXPECT_EQUAL(t.s, "a string longer than the small buffer");
+  EXPECT_EQUAL(t.v.size(), 2);
+  EXPECT_EQUAL(t.v[1], "and a third long string");
+}
+// --------------------------------------------------------------------------
 void test_read_pair () {
   test7 t;
   std::istringstream is("{\"v\":[\"Any Text\",4711]}");
@@ -109,6 +443,35 @@ void test_read_map () {
   EXPECT_EQUAL(m, expected);
 }
 
+// --------------------------------------------------------------------------
+void test_read_containers () {
+  std::istringstream is1("{\"one\":1,\"three\":3,\"two\":2}");
+  std::unordered_map<std::string, double> um;
+  io::read_json(is1, um);
+  std::unordered_map<std::string, double> expected_um { { "one", 1 }, { "two", 2 }, { "three", 3 } };
+  EXPECT_TRUE(um == expected_um);
+
+  std::istringstream is2("{\"3\":3.3,\"1\":1.1,\"2\":0,\"2\":2.2}");
+  persistent::flat_map<int, double> fm;
+  io::read_json(is2, fm);
+  persistent::flat_map<int, double> expected_fm { { 1, 1.1 }, { 2, 2.2 }, { 3, 3.3 } };
+  EXPECT_TRUE(fm == expected_fm);
+  EXPECT_EQUAL(fm[2], 2.2);
+  EXPECT_TRUE(fm.find(4) == fm.end());
+
+  std::istringstream is3("[3,1,2,1]");
+  std::set<int> s;
+  io::read_json(is3, s);
+  std::set<int> expected_s { 1, 2, 3 };
+  EXPECT_EQUAL(s, expected_s);
+
+  std::istringstream is4("[\"b\",\"a\"]");
+  std::unordered_set<std::string> us;
+  io::read_json(is4, us);
+  std::unordered_set<std::string> expected_us { "a", "b" };
+  EXPECT_TRUE(us == expected_us);
+}
+
 // --------------------------------------------------------------------------
 void test_read_1 () {
 
@@ -175,16 +538,25 @@ void test_read_6 () {
 
   test_int64 t1;
   std::istringstream is("{\"i\":4711,\"k\":815}");
-  try {
-    io::read_json(is, t1);
-    EXPECT_FALSE("Exception expected");
-  } catch (std::exception& ex) {
-    EXPECT_TRUE("Exception expected");
-  }
+  io::read_json(is, t1);
 
   EXPECT_EQUAL(t1.i, 4711);
   EXPECT_EQUAL(t1.j, 0);
-  EXPECT_TRUE(is.good());
+  EXPECT_TRUE(is.eof());
+}
+
+// --------------------------------------------------------------------------
+void test_read_skip () {
+
+  test2 t2;
+  std::istringstream is("{\"i1\":815, \"k\":{\"a\":[1, {\"b\":\"x,}]\\\"\"}, null, true]},"
+                        " \"t1\":{\"i\":911, \"l\":[[], {}], \"j\":203}, \"m\": -1.5e3, \"i2\": 4711}");
+  io::read_json(is, t2);
+
+  EXPECT_EQUAL(t2.i1, 815);
+  EXPECT_EQUAL(t2.t1.i, 911);
+  EXPECT_EQUAL(t2.t1.j, 203);
+  EXPECT_EQUAL(*(t2.i2), 4711);
 }
 
 // --------------------------------------------------------------------------
@@ -276,6 +648,121 @@ void test_read_12 () {
   EXPECT_EQUAL(s.sysstat.hosts[0].statistics[0].cpu_load[12].cpu, std::string("11"));
 }
 
+// --------------------------------------------------------------------------
+struct test_outside : private persistent_struct {
+  static int64_t o;
+  int64_t i = 0;
+
+  auto attributes () {
+    return make_attributes(attribute(i, "i"), attribute(o, "o"));
+  }
+};
+
+int64_t test_outside::o = 0;
+
+// --------------------------------------------------------------------------
+void test_read_fields () {
+  test2 t;
+  std::istringstream is("{\"i2\":3,\"x\":[1,{\"i\":2}],\"t1\":{\"j\":5,\"i\":4},\"i1\":1,\"i1\":6}");
+
+  io::read_json(is, t);
+
+  EXPECT_EQUAL(t.i1, 6);
+  EXPECT_EQUAL(t.t1.i, 4);
+  EXPECT_EQUAL(t.t1.j, 5);
+  EXPECT_TRUE(t.i2 && (*t.i2 == 3));
+
+  // duplicate names are read by the first member that takes the value
+  static_assert(io::field_table<test5>::plain, "test5 is table driven");
+  test5 t5;
+  std::istringstream is5("{\"i\":[\"a\"],\"i\":\"b\"}");
+  io::read_json(is5, t5);
+  EXPECT_EQUAL(t5.i, "b");
+  EXPECT_EQUAL(t5.l.size(), 1);
+
+  // members outside of the struct are accessed through the attributes
+  test_outside o;
+  std::istringstream iso("{\"i\":1,\"o\":2}");
+  io::read_json(iso, o);
+  EXPECT_EQUAL(o.i, 1);
+  EXPECT_EQUAL(test_outside::o, 2);
+  std::ostringstream os;
+  io::write_json(os, o, false);
+  EXPECT_EQUAL(os.str(), "{\"i\":1,\"o\":2}");
+}
+
+// --------------------------------------------------------------------------
+void test_push_1 () {
+  test_int64 t1;
+  io::json_push_parser<test_int64> p(t1);
+
+  const std::string part1 = "{\"i\":47";
+  EXPECT_FALSE(p.feed(part1.data(), part1.size()));
+  EXPECT_EQUAL(t1.i, 0);
+
+  const std::string part2 = "11, \"j\":";
+  EXPECT_FALSE(p.feed(part2.data(), part2.size()));
+  EXPECT_EQUAL(t1.i, 4711);
+  EXPECT_EQUAL(t1.j, 0);
+
+  const std::string part3 = "815}{\"i\":1}";
+  EXPECT_TRUE(p.feed(part3.data(), part3.size()));
+  EXPECT_EQUAL(t1.i, 4711);
+  EXPECT_EQUAL(t1.j, 815);
+
+  p.reset();
+  EXPECT_TRUE(p.feed(nullptr, 0));
+  EXPECT_EQUAL(t1.i, 1);
+}
+
+// --------------------------------------------------------------------------
+void test_push_2 () {
+  std::vector<int64_t> v;
+  io::json_push_parser<std::vector<int64_t>> p(v);
+
+  const std::string part1 = "[1,2,";
+  EXPECT_FALSE(p.feed(part1.data(), part1.size()));
+  const std::string part2 = "3,4,5]";
+  EXPECT_TRUE(p.feed(part2.data(), part2.size()));
+
+  std::vector<int64_t> expected = {1, 2, 3, 4, 5};
+  EXPECT_EQUAL(v, expected);
+}
+
+// --------------------------------------------------------------------------
+#ifndef WIN32
+void test_push_pipe () {
+  std::ifstream f("test.json");
+  const std::string doc((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+
+  int fds[2];
+  EXPECT_EQUAL(pipe(fds), 0);
+
+  std::thread writer([&] () {
+    for (std::size_t i = 0; i < doc.size(); i += 7) {
+      write(fds[1], doc.data() + i, std::min<std::size_t>(7, doc.size() - i));
+    }
+    close(fds[1]);
+  });
+
+  MpStat s;
+  io::json_push_parser<MpStat> p(s);
+  char chunk[16];
+  bool complete = false;
+  for (auto n = read(fds[0], chunk, sizeof(chunk)); n > 0; n = read(fds[0], chunk, sizeof(chunk))) {
+    complete = p.feed(chunk, n);
+  }
+  writer.join();
+  close(fds[0]);
+
+  EXPECT_TRUE(complete);
+  EXPECT_EQUAL(s.sysstat.hosts.size(), 1);
+  EXPECT_EQUAL(s.sysstat.hosts[0].number_of_cpus, 12);
+  EXPECT_EQUAL(s.sysstat.hosts[0].statistics[0].cpu_load.size(), 13);
+  EXPECT_EQUAL(s.sysstat.hosts[0].statistics[0].cpu_load[12].cpu, std::string("11"));
+}
+#endif // WIN32
+
 // --------------------------------------------------------------------------
 void test_write_1 () {
   int64_t i = 4711;
@@ -331,6 +818,19 @@ void test_write_6 () {
   EXPECT_EQUAL(os.str(),"{\"i\":[\"List item 1\",\"List item 2\"],\"i\":\"Text 6\"}");
 }
 
+// --------------------------------------------------------------------------
+void test_write_keys () {
+  test_int64 t1;
+  t1.i = 1;
+  t1.j = 2;
+  std::ostringstream os;
+  io::write_json(os, t1, false);
+  io::write_json(os, t1, true);
+  io::write_json(os, t1, false);
+
+  EXPECT_EQUAL(os.str(), "{\"i\":1,\"j\":2}{\n  \"i\": 1,\n  \"j\": 2\n}{\"i\":1,\"j\":2}");
+}
+
 // --------------------------------------------------------------------------
 void test_write_array () {
 
@@ -348,6 +848,64 @@ void test_write_vector () {
   EXPECT_EQUAL(os.str(),"\"v\":[1,2,3,4,5]");
 }
 // --------------------------------------------------------------------------
+void test_write_optional () {
+  test8 t;
+  t.v = 7;
+  std::ostringstream os;
+  io::write_json(os, t, false);
+  EXPECT_EQUAL(os.str(), "{\"i\":null,\"v\":[0,7]}");
+
+  t.o = 5;
+  t.v = std::string("abc");
+  std::ostringstream os2;
+  io::write_json(os2, t, false);
+  EXPECT_EQUAL(os2.str(), "{\"i\":5,\"v\":[1,\"abc\"]}");
+}
+// --------------------------------------------------------------------------
+struct unregistered_shape : public shape {};
+
+void test_write_polymorphic () {
+  test9 t;
+  auto c = std::make_shared<circle>();
+  c->i = 2;
+  c->r = 3;
+  t.s = c;
+  auto l = std::make_shared<label>();
+  l->i = 4;
+  l->text = "abc";
+  t.l = { l, nullptr, std::make_shared<shape>() };
+  std::ostringstream os;
+  io::write_json(os, t, false);
+  EXPECT_EQUAL(os.str(), "{\"i\":[1,{\"i\":2,\"j\":3}],\"v\":[[2,{\"i\":4,\"v\":\"abc\"}],null,[0,{\"i\":0}]]}");
+
+  t.s = std::make_shared<unregistered_shape>();
+  std::ostringstream os2;
+  try {
+    io::write_json(os2, t, false);
+    EXPECT_TRUE(!"Exception expected");
+  } catch (std::exception&) {}
+}
+// --------------------------------------------------------------------------
+void test_write_shared () {
+  test10 t;
+  t.s1 = t.s2 = std::make_shared<label>();
+  auto i = std::make_shared<test_int64>();
+  i->i = 4;
+  i->j = 5;
+  t.v = { i, i, nullptr };
+  {
+    io::shared_scope scope;
+    std::ostringstream os;
+    io::write_json(os, t, false);
+    EXPECT_EQUAL(os.str(), "{\"i\":[0,[2,{\"i\":0,\"v\":\"\"}]],\"j\":[0,null],"
+                           "\"v\":[[1,{\"i\":4,\"j\":5}],[1,null],null]}");
+  }
+  std::ostringstream os2;
+  io::write_json(os2, t, false);
+  EXPECT_EQUAL(os2.str(), "{\"i\":[2,{\"i\":0,\"v\":\"\"}],\"j\":[2,{\"i\":0,\"v\":\"\"}],"
+                          "\"v\":[{\"i\":4,\"j\":5},{\"i\":4,\"j\":5},null]}");
+}
+// --------------------------------------------------------------------------
 void test_write_pair () {
   test7 t("Any Text", 4711);
   std::ostringstream os;
@@ -363,6 +921,23 @@ void test_write_map () {
 
   EXPECT_EQUAL(os.str(), "{\"one\":1,\"three\":3,\"two\":2}");
 }
+// --------------------------------------------------------------------------
+void test_write_containers () {
+  persistent::flat_map<int, double> fm { { 3, 3.3 }, { 1, 1.1 }, { 2, 2.2 } };
+  std::ostringstream os1;
+  io::write_json(os1, fm, false);
+  EXPECT_EQUAL(os1.str(), "{\"1\":1.1,\"2\":2.2,\"3\":3.3}");
+
+  std::unordered_map<std::string, int> um { { "one", 1 } };
+  std::ostringstream os2;
+  io::write_json(os2, um, false);
+  EXPECT_EQUAL(os2.str(), "{\"one\":1}");
+
+  std::set<int> s { 3, 1, 2 };
+  std::ostringstream os3;
+  io::write_json(os3, s, false);
+  EXPECT_EQUAL(os3.str(), "[1,2,3]");
+}
 
 // --------------------------------------------------------------------------
 void test_main (const testing::start_params& params) {
@@ -371,31 +946,56 @@ void test_main (const testing::start_params& params) {
   run_test(test_read_all_basic_types);
   run_test(test_read_array);
   run_test(test_read_vector);
+  run_test(test_read_vector_reserve);
   run_test(test_read_pair);
+  run_test(test_read_into);
+  run_test(test_read_into_stale);
+  run_test(test_read_optional);
+  run_test(test_read_variant_repeated);
+  run_test(test_read_polymorphic);
+  run_test(test_read_shared);
+  run_test(test_read_borrowed);
+  run_test(test_read_escaped);
+  run_test(test_read_pmr);
+  run_test(test_read_into_allocations);
   run_test(test_read_map);
+  run_test(test_read_containers);
   run_test(test_read_1);
   run_test(test_read_2);
   run_test(test_read_3);
   run_test(test_read_4);
   run_test(test_read_5);
   run_test(test_read_6);
+  run_test(test_read_skip);
   run_test(test_read_7);
   run_test(test_read_8);
   run_test(test_read_9);
   run_test(test_read_10);
   run_test(test_read_11);
   run_test(test_read_12);
+  run_test(test_read_fields);
+
+  run_test(test_push_1);
+  run_test(test_push_2);
+#ifndef WIN32
+  run_test(test_push_pipe);
+#endif // WIN32
 
   run_test(test_write_array);
   run_test(test_write_vector);
   run_test(test_write_pair);
+  run_test(test_write_optional);
+  run_test(test_write_polymorphic);
+  run_test(test_write_shared);
   run_test(test_write_map);
+  run_test(test_write_containers);
   run_test(test_write_1);
   run_test(test_write_2);
   run_test(test_write_3);
   run_test(test_write_4);
   run_test(test_write_5);
   run_test(test_write_6);
+  run_test(test_write_keys);
 }
 
 // --------------------------------------------------------------------------
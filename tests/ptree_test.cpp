@@ -0,0 +1,168 @@
+/**
+* @copyright (c) 2015-2021 Ing. Buero Rothfuss
+*                          Riedlinger Str. 8
+*                          70327 Stuttgart
+*                          Germany
+*                          http://www.rothfuss-web.de
+*
+* @author    <a href="mailto:armin@rothfuss-web.de">Armin Rothfuss</a>
+*
+* Project    persistent lib
+*
+* @brief     C++ struct persistence test
+*
+* @license   MIT license. See accompanying file LICENSE.
+*/
+
+#include <fstream>
+
+#include "persistent/persistent_ptree.h"
+#include "persistent/persistent_json.h"
+#include <testing/testing.h>
+
+#include "test_structs.h"
+
+// --------------------------------------------------------------------------
+void test_write_1 () {
+  test2 t2;
+  t2.i1 = 815;
+  t2.t1.i = 4711;
+  io::ptree pt;
+  io::write(pt, t2);
+
+  EXPECT_EQUAL(pt.size(), 3);
+  EXPECT_EQUAL(pt.get<int>("i1"), 815);
+  EXPECT_EQUAL(pt.get<int>("t1.i"), 4711);
+  EXPECT_EQUAL(pt.get<int>("t1.j"), 0);
+  EXPECT_TRUE(pt.get_child("i2").empty());
+}
+
+// --------------------------------------------------------------------------
+void test_write_list () {
+  test7 t7("Any Text", 4711);
+  io::ptree pt;
+  io::write(pt, t7);
+
+  const io::ptree& v = pt.get_child("v");
+  EXPECT_EQUAL(v.size(), 2);
+  EXPECT_EQUAL(v.front().second.data(), "Any Text");
+  EXPECT_EQUAL(v.back().second.data(), "4711");
+
+  std::map<std::string, double> m { { "one", 1 }, { "two", 2.5 } };
+  io::ptree pt2;
+  io::write(pt2, m);
+  EXPECT_EQUAL(pt2.size(), 2);
+  EXPECT_EQUAL(pt2.get<double>("two"), 2.5);
+}
+
+// --------------------------------------------------------------------------
+void test_read_1 () {
+  io::ptree pt;
+  pt.put("t1.k", "unknown");
+  pt.put("t1.j", 203);
+  pt.put("t1.i", 911);
+  pt.put("i1", 815);
+  pt.put("i2", 4711);
+
+  test2 t2;
+  EXPECT_TRUE(io::read(pt, t2));
+  EXPECT_EQUAL(t2.i1, 815);
+  EXPECT_EQUAL(t2.t1.i, 911);
+  EXPECT_EQUAL(t2.t1.j, 203);
+  EXPECT_EQUAL(*(t2.i2), 4711);
+}
+
+// --------------------------------------------------------------------------
+void test_round_trip () {
+  MpStat s;
+  std::ifstream is("test.json");
+  io::read_json(is, s);
+
+  io::ptree pt;
+  io::write(pt, s);
+
+  MpStat s2;
+  EXPECT_TRUE(io::read(pt, s2));
+
+  std::ostringstream os1;
+  io::write_json(os1, s);
+  std::ostringstream os2;
+  io::write_json(os2, s2);
+  EXPECT_EQUAL(os1.str(), os2.str());
+}
+
+// --------------------------------------------------------------------------
+void test_containers () {
+  std::unordered_map<int, std::string> um { { 1, "one" }, { 2, "two" } };
+  persistent::flat_map<std::string, int> fm { { "b", 2 }, { "a", 1 } };
+  std::set<int> s { 3, 1, 2 };
+  io::ptree pt;
+  io::write(pt.add_child("um", io::ptree()), um);
+  io::write(pt.add_child("fm", io::ptree()), fm);
+  io::write(pt.add_child("s", io::ptree()), s);
+
+  std::unordered_map<int, std::string> um2;
+  persistent::flat_map<std::string, int> fm2;
+  std::set<int> s2;
+  io::read(pt.get_child("um"), um2);
+  io::read(pt.get_child("fm"), fm2);
+  io::read(pt.get_child("s"), s2);
+  EXPECT_TRUE(um2 == um);
+  EXPECT_TRUE(fm2 == fm);
+  EXPECT_EQUAL(s2, s);
+
+  test8 t8;
+  t8.o = 5;
+  t8.v = std::string("abc");
+  io::write(pt.add_child("t8", io::ptree()), t8);
+  test8 t8b;
+  io::read(pt.get_child("t8"), t8b);
+  EXPECT_EQUAL(t8b.o.value_or(0), 5);
+  EXPECT_EQUAL(std::get<std::string>(t8b.v), "abc");
+
+  test9 t9;
+  auto l = std::make_shared<label>();
+  l->text = "abc";
+  t9.s = l;
+  io::write(pt.add_child("t9", io::ptree()), t9);
+  test9 t9b;
+  io::read(pt.get_child("t9"), t9b);
+  EXPECT_EQUAL(typeid(*t9b.s), typeid(label));
+  EXPECT_EQUAL(static_cast<label&>(*t9b.s).text, "abc");
+}
+
+// --------------------------------------------------------------------------
+struct ptree_test : public ptree_struct<ptree_test> {
+  int i = 0;
+  std::vector<std::string> v;
+
+  auto attributes () {
+    return make_attributes(attribute(i, "i"), attribute(v, "v"));
+  }
+};
+
+void test_ptree_struct () {
+  ptree_test t;
+  t.i = 42;
+  t.v = { "a", "b" };
+  io::ptree pt;
+  t.write(pt);
+
+  ptree_test t2;
+  EXPECT_TRUE(t2.read(pt));
+  EXPECT_EQUAL(t2.i, 42);
+  EXPECT_EQUAL(t2.v, t.v);
+}
+
+// --------------------------------------------------------------------------
+void test_main (const testing::start_params& params) {
+  testing::log_info("Running " __FILE__);
+  run_test(test_write_1);
+  run_test(test_write_list);
+  run_test(test_read_1);
+  run_test(test_round_trip);
+  run_test(test_containers);
+  run_test(test_ptree_struct);
+}
+
+// --------------------------------------------------------------------------
@@ -17,6 +17,10 @@
 #pragma once
 
 #include <memory>
+#include <memory_resource>
+#include <map>
+#include <optional>
+#include <variant>
 #include "persistent/persistent.h"
 
 using namespace persistent;
@@ -158,6 +162,92 @@ struct test7 : private persistent_struct {
   std::pair<std::string, int> p;
 };
 
+// --------------------------------------------------------------------------
+struct test8 : private persistent_struct {
+  auto attributes () {
+    return make_attributes(attribute(o, names::i), attribute(v, names::v));
+  }
+
+  std::optional<int> o;
+  std::variant<int, std::string, test_int64> v;
+};
+
+// --------------------------------------------------------------------------
+struct shape : private persistent_struct {
+  virtual ~shape () = default;
+
+  auto attributes () {
+    return make_attributes(attribute(i, names::i));
+  }
+
+  int i = 0;
+};
+
+struct circle : public shape {
+  auto attributes () {
+    return make_attributes(attribute(i, names::i), attribute(r, names::j));
+  }
+
+  int r = 0;
+};
+
+struct label : public shape {
+  auto attributes () {
+    return make_attributes(attribute(i, names::i), attribute(text, names::v));
+  }
+
+  std::string text;
+};
+
+namespace persistent {
+
+  template<>
+  struct derived_types<shape> : type_list<shape, circle, label> {};
+
+}
+
+struct test9 : private persistent_struct {
+  auto attributes () {
+    return make_attributes(attribute(s, names::i), attribute(l, names::v));
+  }
+
+  std::shared_ptr<shape> s;
+  std::vector<std::shared_ptr<shape>> l;
+};
+
+// --------------------------------------------------------------------------
+struct test10 : private persistent_struct {
+  auto attributes () {
+    return make_attributes(attribute(s1, names::i), attribute(s2, names::j), attribute(v, names::v));
+  }
+
+  std::shared_ptr<shape> s1;
+  std::shared_ptr<shape> s2;
+  std::vector<std::shared_ptr<test_int64>> v;
+};
+
+// --------------------------------------------------------------------------
+struct test11 : private persistent_struct {
+  auto attributes () {
+    return make_attributes(attribute(s, names::i), attribute(v, names::v));
+  }
+
+  std::string_view s;
+  std::vector<std::string_view> v;
+};
+
+// --------------------------------------------------------------------------
+struct test12 : private persistent_struct {
+  auto attributes () {
+    return make_attributes(attribute(s, names::i), attribute(v, names::v), attribute(m, names::j), attribute(p, names::i1));
+  }
+
+  std::pmr::string s;
+  std::pmr::vector<std::pmr::string> v;
+  std::pmr::map<int, std::pmr::string> m;
+  std::shared_ptr<test_int64> p;
+};
+
 // --------------------------------------------------------------------------
 enum class key : char {
   first = 'F',
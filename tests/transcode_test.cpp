@@ -0,0 +1,128 @@
+/**
+* @copyright (c) 2015-2021 Ing. Buero Rothfuss
+*                          Riedlinger Str. 8
+*                          70327 Stuttgart
+*                          Germany
+*                          http://www.rothfuss-web.de
+*
+* @author    <a href="mailto:armin@rothfuss-web.de">Armin Rothfuss</a>
+*
+* Project    persistent lib
+*
+* @brief     C++ struct persistence test
+*
+* @license   MIT license. See accompanying file LICENSE.
+*/
+
+#include <fstream>
+#include <iterator>
+
+#include "persistent/persistent_transcode.h"
+#include <testing/testing.h>
+
+#include "test_structs.h"
+
+// --------------------------------------------------------------------------
+std::string read_file (const char* name) {
+  std::ifstream f(name);
+  return std::string((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+}
+
+// --------------------------------------------------------------------------
+void test_json_to_xml () {
+  const std::string json = read_file("test.json");
+
+  std::istringstream is(json);
+  std::ostringstream os;
+  EXPECT_TRUE(io::json_to_xml<MpStat>(is, os));
+
+  MpStat s;
+  std::istringstream is2(json);
+  io::read_json(is2, s);
+  std::ostringstream expected;
+  io::write_xml(expected, s);
+
+  EXPECT_EQUAL(os.str(), expected.str());
+}
+
+// --------------------------------------------------------------------------
+void test_json_to_ini () {
+  const std::string json = read_file("test.json");
+
+  std::istringstream is(json);
+  std::ostringstream os;
+  EXPECT_TRUE(io::json_to_ini<MpStat>(is, os));
+
+  MpStat s;
+  std::istringstream is2(json);
+  io::read_json(is2, s);
+  std::ostringstream expected;
+  io::write_ini(expected, s);
+
+  EXPECT_EQUAL(os.str(), expected.str());
+}
+
+// --------------------------------------------------------------------------
+void test_xml_to_json () {
+  MpStat s;
+  std::istringstream is(read_file("test.json"));
+  io::read_json(is, s);
+  std::ostringstream xml;
+  io::write_xml(xml, s);
+
+  std::istringstream is2(xml.str());
+  std::ostringstream os;
+  EXPECT_TRUE(io::xml_to_json<MpStat>(is2, os, false));
+
+  std::ostringstream expected;
+  io::write_json(expected, s, false);
+  EXPECT_EQUAL(os.str(), expected.str());
+}
+
+// --------------------------------------------------------------------------
+void test_transcode_types () {
+  std::istringstream is("{\"i1\": 815, \"k\": [1, {\"a\": 2}], \"t1\": {\"j\": 203, \"i\": 911}, \"i2\": null}");
+  std::ostringstream os;
+  EXPECT_TRUE(io::json_to_xml<test2>(is, os, false));
+  EXPECT_EQUAL(os.str(), io::xml::s_header + io::xml::s_body +
+                         "<i1>815</i1><t1><j>203</j><i>911</i></t1><i2></i2>" + io::xml::s_nbody);
+
+  std::istringstream is2("{\"v\": [\"Any Text\", 4711]}");
+  std::ostringstream os2;
+  EXPECT_TRUE(io::json_to_ini<test7>(is2, os2));
+  EXPECT_EQUAL(os2.str(), "v.0=Any Text\nv.1=4711\n");
+
+  std::istringstream is3("{\"one\": 1, \"two\": 2}");
+  std::ostringstream os3;
+  io::json_formatter_context out(os3, false);
+  io::json_parser_context in(is3);
+  EXPECT_TRUE((io::transcode<std::map<std::string, double>>(in, out)));
+  EXPECT_EQUAL(os3.str(), "{\"one\":1,\"two\":2}");
+
+  std::istringstream is4("{\"i\": null, \"v\": [1, \"abc\"]}");
+  std::ostringstream os4;
+  EXPECT_TRUE(io::json_to_ini<test8>(is4, os4));
+  EXPECT_EQUAL(os4.str(), "i=\nv.0=1\nv.1=abc\n");
+
+  std::istringstream is5("{\"i\": [2, {\"v\": \"abc\"}], \"v\": [null, [1, {\"j\": 3}]]}");
+  std::ostringstream os5;
+  EXPECT_TRUE(io::json_to_ini<test9>(is5, os5));
+  EXPECT_EQUAL(os5.str(), "i.0=2\ni.1.v=abc\nv.0=\nv.1.0=1\nv.1.1.j=3\n");
+
+  io::shared_scope scope;
+  std::istringstream is6("{\"i\": [0, [1, {\"j\": 3}]], \"j\": [0, null]}");
+  std::ostringstream os6;
+  EXPECT_TRUE(io::json_to_ini<test10>(is6, os6));
+  EXPECT_EQUAL(os6.str(), "i.0=0\ni.1.0=1\ni.1.1.j=3\nj.0=0\nj.1=\n");
+}
+
+// --------------------------------------------------------------------------
+void test_main (const testing::start_params& params) {
+  testing::log_info("Running " __FILE__);
+  run_test(test_json_to_xml);
+  run_test(test_json_to_ini);
+  run_test(test_xml_to_json);
+  run_test(test_transcode_types);
+}
+
+// --------------------------------------------------------------------------
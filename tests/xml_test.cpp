@@ -59,6 +59,12 @@ void test_read_prop_type () {
   io::read_xml(is, at);
 
   EXPECT_EQUAL(value, expected.second, " for type ", typeid(T).name(), " with source ", str);
+
+  T value2 = {};
+  auto at2 = attribute(value2, "i");
+  io::read_xml(build_xml(str), at2);
+
+  EXPECT_EQUAL(value2, expected.second, " for type ", typeid(T).name(), " with buffer ", str);
 }
 // --------------------------------------------------------------------------
 template<typename T, typename... Types>
@@ -115,6 +121,16 @@ void test_read_pair () {
   EXPECT_FALSE(is.good());
 }
 // --------------------------------------------------------------------------
+void test_read_optional () {
+  test8 t;
+  t.o = 9;
+  std::istringstream is(build_xml("<i></i><v><ol><li>2</li><li><i>3</i><j>4</j></li></ol></v>"));
+  io::read_xml(is, t);
+  EXPECT_FALSE(t.o.has_value());
+  EXPECT_EQUAL(std::get<test_int64>(t.v).i, 3);
+  EXPECT_EQUAL(std::get<test_int64>(t.v).j, 4);
+}
+// --------------------------------------------------------------------------
 void test_read_map () {
   std::istringstream is(build_xml("<one>1</one><three>3</three><two>2</two>"));
   std::map<std::string, double> m;
@@ -196,19 +212,120 @@ void test_read_5 () {
 void test_read_6 () {
   test_int64 t1;
   std::istringstream is(build_xml("<t1><i>4711</i><k>815</k></t1>"));
-  try {
-    auto at = attribute(t1, "t1");
-    io::read_xml(is, at);
-    EXPECT_FALSE("Exception expected");
-  } catch (std::exception& ex) {
-    EXPECT_TRUE("Exception expected");
-  }
+  auto at = attribute(t1, "t1");
+  io::read_xml(is, at);
 
   EXPECT_EQUAL(t1.i, 4711);
   EXPECT_EQUAL(t1.j, 0);
   EXPECT_TRUE(is.good());
 }
 
+// --------------------------------------------------------------------------
+void test_read_skip () {
+  test2 t2;
+  std::istringstream is(build_xml("<t2><i1>815</i1><k><a><ol><li>1</li><li><b>x</b><c/></li></ol></a></k>"
+                                  "<t1><i>911</i><l><ol></ol></l><j>203</j></t1><m>-1</m><i2>4711</i2></t2>"));
+  auto at = attribute(t2, "t2");
+  io::read_xml(is, at);
+
+  EXPECT_EQUAL(t2.i1, 815);
+  EXPECT_EQUAL(t2.t1.i, 911);
+  EXPECT_EQUAL(t2.t1.j, 203);
+  EXPECT_EQUAL(*(t2.i2), 4711);
+  EXPECT_TRUE(is.good());
+}
+
+// --------------------------------------------------------------------------
+void test_read_borrowed () {
+  test11 t;
+  t.s = "a<b";
+  t.v = { "plain", "" };
+  std::ostringstream os;
+  io::write_xml(os, t);
+  const std::string data = os.str();
+
+  test11 t2;
+  io::scratch_arena scratch;
+  EXPECT_TRUE(io::read_xml(data, t2, scratch));
+  EXPECT_EQUAL(t2.s, "a<b");
+  EXPECT_EQUAL(t2.v.size(), 2);
+  EXPECT_EQUAL(t2.v[0], "plain");
+  EXPECT_TRUE((t2.v[0].data() > data.data()) && (t2.v[0].data() < data.data() + data.size()));
+
+  std::ostringstream os2;
+  io::write_xml(os2, t2, true, true);
+  const std::string data2 = os2.str();
+  test11 t3;
+  EXPECT_TRUE(io::read_xml(data2, t3, scratch, true));
+  EXPECT_EQUAL(t3.s, "a<b");
+  EXPECT_EQUAL(t3.v[0], "plain");
+
+  try {
+    io::read_xml(data, t2);
+    EXPECT_TRUE(!"Exception expected");
+  } catch (std::exception&) {}
+}
+// --------------------------------------------------------------------------
+void test_read_pmr () {
+  std::pmr::monotonic_buffer_resource resource;
+  test12 t;
+  t.s = "a<b";
+  t.v = { "plain" };
+  t.m[1] = "one";
+  std::ostringstream os;
+  io::write_xml(os, t);
+  test12 t2;
+  EXPECT_TRUE(io::read_xml(os.str(), t2, &resource));
+  EXPECT_EQUAL(t2.s, "a<b");
+  EXPECT_TRUE(t2.s.get_allocator().resource() == &resource);
+  EXPECT_TRUE(t2.v.get_allocator().resource() == &resource);
+  EXPECT_EQUAL(t2.v[0], "plain");
+  EXPECT_TRUE(t2.v[0].get_allocator().resource() == &resource);
+  EXPECT_EQUAL(t2.m[1], "one");
+
+  std::pmr::map<std::pmr::string, int> m;
+  EXPECT_TRUE(io::read_xml(build_xml("<a_long_key_longer_than_the_small_buffer>1</a_long_key_longer_than_the_small_buffer><b>2</b>"), m, &resource));
+  EXPECT_EQUAL(m.size(), 2);
+  EXPECT_EQUAL(m.begin()->first, "a_long_key_longer_than_the_small_buffer");
+  EXPECT_TRUE(m.begin()->first.get_allocator().resource() == &resource);
+}
+// --------------------------------------------------------------------------
+void test_read_buffer () {
+  MpStat s;
+  s.sysstat.hosts.resize(2);
+  s.sysstat.hosts[0].nodename = "host";
+  s.sysstat.hosts[0].number_of_cpus = 4;
+  s.sysstat.hosts[1].statistics.resize(1);
+  s.sysstat.hosts[1].statistics[0].timestamp = "06:54:18 PM";
+  s.sysstat.hosts[1].statistics[0].cpu_load.resize(2);
+  s.sysstat.hosts[1].statistics[0].cpu_load[1] = { "all", 0.5F, 1, 2, 3, 4, 5, 6, 7, 8, 97.25F };
+
+  std::ostringstream os;
+  io::write_xml(os, s);
+  const std::string data = os.str();
+
+  MpStat s2;
+  EXPECT_TRUE(io::read_xml(data, s2));
+  EXPECT_EQUAL(s2.sysstat.hosts[0].nodename, "host");
+  EXPECT_EQUAL(s2.sysstat.hosts[0].number_of_cpus, 4);
+  EXPECT_EQUAL(s2.sysstat.hosts[1].statistics[0].timestamp, "06:54:18 PM");
+  EXPECT_EQUAL(s2.sysstat.hosts[1].statistics[0].cpu_load[1].cpu, "all");
+  EXPECT_EQUAL(s2.sysstat.hosts[1].statistics[0].cpu_load[1].idle, 97.25F);
+
+  std::ostringstream os2;
+  io::write_xml(os2, s2);
+  EXPECT_EQUAL(os2.str(), data);
+
+  test2 t2;
+  auto at = attribute(t2, "t2");
+  io::read_xml(build_xml("<t2><i1>815</i1><k><a><ol><li>1</li><li><b>x</b><c/></li></ol></a></k>"
+                         "<t1><i>911</i><j>203</j></t1><i2>4711</i2></t2>"), at);
+  EXPECT_EQUAL(t2.i1, 815);
+  EXPECT_EQUAL(t2.t1.i, 911);
+  EXPECT_EQUAL(t2.t1.j, 203);
+  EXPECT_EQUAL(*(t2.i2), 4711);
+}
+
 // --------------------------------------------------------------------------
 void test_read_7 () {
   test3 t3;
@@ -378,6 +495,228 @@ void test_write_map () {
   EXPECT_EQUAL(os.str(), expected);
 }
 
+// --------------------------------------------------------------------------
+std::string build_xml_attributes (const std::string& t) {
+  std::ostringstream os;
+  os << io::xml::s_header;
+  os << "<body" << t;
+  return os.str();
+}
+
+// --------------------------------------------------------------------------
+void test_write_attributes () {
+  test2 t2;
+  t2.t1.i = 4711;
+  std::ostringstream os;
+  io::write_xml(os, t2, false, true);
+  EXPECT_EQUAL(os.str(), build_xml_attributes(" i1=\"0\"><t1 i=\"4711\" j=\"0\"/><i2/></body>"));
+
+  test3 t3;
+  t3.v().resize(2);
+  std::ostringstream os3;
+  io::write_xml(os3, t3, false, true);
+  EXPECT_EQUAL(os3.str(), build_xml_attributes("><v><li i=\"0\" j=\"0\"/><li i=\"0\" j=\"0\"/></v></body>"));
+
+  test7 t7("Any Text", 4711);
+  std::ostringstream os7;
+  io::write_xml(os7, t7, false, true);
+  EXPECT_EQUAL(os7.str(), build_xml_attributes("><v><li>Any Text</li><li>4711</li></v></body>"));
+
+  std::vector<int> v;
+  std::ostringstream osv;
+  io::write_xml(osv, attribute(v, "v"), false, true);
+  EXPECT_EQUAL(osv.str(), build_xml_attributes("><v/></body>"));
+}
+
+// --------------------------------------------------------------------------
+struct test_char : private persistent_struct {
+  char c = 0;
+
+  auto attributes () {
+    return make_attributes(attribute(c, "c"));
+  }
+};
+
+// --------------------------------------------------------------------------
+struct test_fields : private persistent_struct {
+  static std::size_t attributes_calls;
+
+  int64_t a = 0;
+  int64_t b = 0;
+  std::string s;
+  test_int64 t;
+
+  auto attributes () {
+    ++attributes_calls;
+    return make_attributes(attribute(a, "a"), attribute(b, "b"), attribute(s, "s"), attribute(t, "t"));
+  }
+};
+
+std::size_t test_fields::attributes_calls = 0;
+
+// --------------------------------------------------------------------------
+void test_read_attributes_table () {
+  static_assert(io::table_driven<io::xml_attribute_parser_context>::value, "attribute reads are table driven");
+  static_assert(io::table_driven<io::xml_buffer_context>::value, "buffer reads are table driven");
+
+  static_assert(io::field_table<test_fields>::plain, "test_fields is table driven");
+  test_fields f;
+  EXPECT_EQUAL(io::field_table<test_fields>::get(f).fields[3].name, "t");
+
+  // attributes out of order, unknown attributes and elements are skipped, members as elements
+  const std::string data = build_xml_attributes(" s=\"text\" x=\"9\" b=\"2\"><y>0</y><t j=\"4\" i=\"3\"/><a>1</a></body>");
+  const std::size_t before = test_fields::attributes_calls;
+  for (int n = 0; n < 10; ++n) {
+    test_fields r;
+    EXPECT_TRUE(io::read_xml(data, r, true));
+    EXPECT_EQUAL(r.a, 1);
+    EXPECT_EQUAL(r.b, 2);
+    EXPECT_EQUAL(r.s, "text");
+    EXPECT_EQUAL(r.t.i, 3);
+    EXPECT_EQUAL(r.t.j, 4);
+  }
+  EXPECT_EQUAL(test_fields::attributes_calls, before);
+
+  // round trip through the writer in attribute mode
+  f.a = 5;
+  f.b = 6;
+  f.s = "abc";
+  f.t.i = 7;
+  f.t.j = 8;
+  std::ostringstream os;
+  io::write_xml(os, f, false, true);
+  test_fields r;
+  std::istringstream is(os.str());
+  EXPECT_TRUE(io::read_xml(is, r, true));
+  EXPECT_EQUAL(r.a, 5);
+  EXPECT_EQUAL(r.b, 6);
+  EXPECT_EQUAL(r.s, "abc");
+  EXPECT_EQUAL(r.t.i, 7);
+  EXPECT_EQUAL(r.t.j, 8);
+}
+
+// --------------------------------------------------------------------------
+void test_read_attributes () {
+  test2 t2;
+  std::istringstream is(build_xml_attributes(" i1=\"815\" k='x'>\n <t1 i = \"911\" j=\"203\"/>"
+                                             "<l a=\"1\"><li/><li><m/></li></l><i2>4711</i2></body>"));
+  EXPECT_TRUE(io::read_xml(is, t2, true));
+  EXPECT_EQUAL(t2.i1, 815);
+  EXPECT_EQUAL(t2.t1.i, 911);
+  EXPECT_EQUAL(t2.t1.j, 203);
+  EXPECT_EQUAL(*(t2.i2), 4711);
+
+  test2 t2b;
+  io::read_xml(build_xml_attributes(" i1=\"1\"><t1 j=\"2\"/><i2/></body>"), t2b, true);
+  EXPECT_EQUAL(t2b.i1, 1);
+  EXPECT_EQUAL(t2b.t1.i, 0);
+  EXPECT_EQUAL(t2b.t1.j, 2);
+  EXPECT_FALSE(t2b.i2);
+
+  test8 t8;
+  io::read_xml(build_xml_attributes("><i>5</i><v><li>1</li><li>abc</li></v></body>"), t8, true);
+  EXPECT_EQUAL(t8.o.value_or(0), 5);
+  EXPECT_EQUAL(std::get<std::string>(t8.v), "abc");
+
+  test7 t7;
+  io::read_xml(build_xml_attributes("><v><li>Any Text</li><li>4711</li></v></body>"), t7, true);
+  EXPECT_EQUAL(t7.p.first, "Any Text");
+  EXPECT_EQUAL(t7.p.second, 4711);
+
+  MpStat s;
+  s.sysstat.hosts.resize(2);
+  s.sysstat.hosts[0].nodename = "host";
+  s.sysstat.hosts[0].number_of_cpus = 4;
+  s.sysstat.hosts[1].statistics.resize(1);
+  s.sysstat.hosts[1].statistics[0].timestamp = "06:54:18 PM";
+  s.sysstat.hosts[1].statistics[0].cpu_load.resize(2);
+  s.sysstat.hosts[1].statistics[0].cpu_load[1] = { "all", 0.5F, 1, 2, 3, 4, 5, 6, 7, 8, 97.25F };
+
+  std::ostringstream os;
+  io::write_xml(os, s, true, true);
+  const std::string data = os.str();
+
+  MpStat s2;
+  EXPECT_TRUE(io::read_xml(data, s2, true));
+  std::ostringstream os2;
+  io::write_xml(os2, s2, true, true);
+  EXPECT_EQUAL(os2.str(), data);
+
+  std::ostringstream os3;
+  io::write_xml(os3, s, false);
+  EXPECT_TRUE(data.size() < os3.str().size());
+}
+
+// --------------------------------------------------------------------------
+void test_escape () {
+  // specials at every position of the 16 byte blocks
+  for (std::size_t i = 0; i < 40; ++i) {
+    const std::string text = std::string(i, 'a') + "<&>\"" + std::string(40 - i, 'b');
+    const std::string expected = std::string(i, 'a') + "&lt;&amp;&gt;&quot;" + std::string(40 - i, 'b');
+    std::ostringstream os;
+    io::xml::write_escaped(os, text);
+    EXPECT_EQUAL(os.str(), expected);
+
+    std::string decoded = os.str();
+    io::xml::unescape(decoded);
+    EXPECT_EQUAL(decoded, text);
+  }
+
+  std::string refs = "&#65;&#x42;&#xe4;&#8364;&#x1F600;&apos;";
+  io::xml::unescape(refs);
+  EXPECT_EQUAL(refs, "AB\xC3\xA4\xE2\x82\xAC\xF0\x9F\x98\x80'");
+
+  test5 t("a < b && c > \"d\"", { "x<y", "&amp;" });
+  std::ostringstream os;
+  io::write_xml(os, t, false);
+  EXPECT_EQUAL(os.str(), build_xml("<i>a &lt; b &amp;&amp; c &gt; &quot;d&quot;</i>"
+                                   "<i><ol><li>x&lt;y</li><li>&amp;amp;</li></ol></i>"));
+
+  test5 t2;
+  std::istringstream is(os.str());
+  io::read_xml(is, t2);
+  EXPECT_EQUAL(t2.i, t.i);
+  EXPECT_EQUAL(t2.l, t.l);
+
+  test5 t3;
+  io::read_xml(os.str(), t3);
+  EXPECT_EQUAL(t3.i, t.i);
+  EXPECT_EQUAL(t3.l, t.l);
+
+  CpuLoad c = { "\"cpu\" & <all>", 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+  std::ostringstream osa;
+  io::write_xml(osa, c, false, true);
+  EXPECT_EQUAL(osa.str(), build_xml_attributes(" cpu=\"&quot;cpu&quot; &amp; &lt;all&gt;\" usr=\"0\" nice=\"0\" sys=\"0\""
+                                                " iowait=\"0\" irq=\"0\" soft=\"0\" steal=\"0\" guest=\"0\" gnice=\"0\" idle=\"0\"/>"));
+
+  CpuLoad c2;
+  io::read_xml(osa.str(), c2, true);
+  EXPECT_EQUAL(c2.cpu, c.cpu);
+
+  // single characters are escaped like strings, in elements and attributes
+  for (const char ch : { '<', '&', '"', 'a' }) {
+    test_char tc;
+    tc.c = ch;
+    std::ostringstream osc;
+    io::write_xml(osc, tc, false);
+    std::ostringstream osca;
+    io::write_xml(osca, tc, false, true);
+    if (ch == '<') {
+      EXPECT_EQUAL(osc.str(), build_xml("<c>&lt;</c>"));
+      EXPECT_EQUAL(osca.str(), build_xml_attributes(" c=\"&lt;\"/>"));
+    }
+
+    test_char r1, r2, r3;
+    std::istringstream isc(osc.str());
+    io::read_xml(isc, r1);
+    io::read_xml(osc.str(), r2);
+    io::read_xml(osca.str(), r3, true);
+    EXPECT_EQUAL(r1.c, ch);
+    EXPECT_EQUAL(r2.c, ch);
+    EXPECT_EQUAL(r3.c, ch);
+  }
+}
+
 // --------------------------------------------------------------------------
 void test_main (const testing::start_params& params) {
   testing::log_info("Running " __FILE__);
@@ -386,6 +725,7 @@ void test_main (const testing::start_params& params) {
   run_test(test_read_array);
   run_test(test_read_vector);
   run_test(test_read_pair);
+  run_test(test_read_optional);
   run_test(test_read_map);
   run_test(test_read_1);
   run_test(test_read_2);
@@ -393,6 +733,10 @@ void test_main (const testing::start_params& params) {
   run_test(test_read_4);
   run_test(test_read_5);
   run_test(test_read_6);
+  run_test(test_read_skip);
+  run_test(test_read_buffer);
+  run_test(test_read_borrowed);
+  run_test(test_read_pmr);
   run_test(test_read_7);
   run_test(test_read_8);
   run_test(test_read_9);
@@ -409,6 +753,11 @@ void test_main (const testing::start_params& params) {
   run_test(test_write_4);
   run_test(test_write_5);
   run_test(test_write_6);
+
+  run_test(test_write_attributes);
+  run_test(test_read_attributes);
+  run_test(test_read_attributes_table);
+  run_test(test_escape);
 }
 
 // --------------------------------------------------------------------------